@@ -1,5 +1,16 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+
+/* The reduction kernels use SSE2 and AVX2 when built for x86-64 with GCC
+   or Clang, which can pick the kernels by CPU at run time */
+#if defined(__GNUC__) && defined(__x86_64__)
+#define LSIMD_X86
+#include <immintrin.h>
+#endif
 
 #include "mpc.h"
 
@@ -32,511 +43,4176 @@ void add_history(char* unused) {}
 
 struct lval;
 struct lenv;
+struct lfunc;
+struct lchunk;
+struct lstr;
 typedef struct lval lval;
 typedef struct lenv lenv;
+typedef struct lfunc lfunc;
+typedef struct lchunk lchunk;
+typedef struct lstr lstr;
+
+
+/* Symbol Interning */
+
+/* Every symbol name is stored exactly once in a global open-addressing
+   table. Symbols hold the canonical pointer, so two symbols are equal
+   exactly when their pointers are. */
+struct {
+    int count;
+    int size;
+    char** names;
+} lsym_table;
+
+unsigned long lsym_hash(char* s) {
+    /* FNV-1a */
+    unsigned long h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void lsym_grow(void) {
+    int old_size = lsym_table.size;
+    char** old = lsym_table.names;
+
+    lsym_table.size = old_size ? old_size * 2 : 256;
+    lsym_table.names = calloc(lsym_table.size, sizeof(char*));
+
+    /* Rehash existing names into the larger table */
+    for (int i = 0; i < old_size; i++) {
+        if (old[i] == NULL) { continue; }
+        unsigned long j = lsym_hash(old[i]) & (lsym_table.size-1);
+        while (lsym_table.names[j]) { j = (j+1) & (lsym_table.size-1); }
+        lsym_table.names[j] = old[i];
+    }
+    free(old);
+}
+
+/* Return the canonical copy of a symbol name, creating it if needed */
+char* lsym_intern(char* s) {
+    /* Keep the load factor under a half */
+    if (2 * (lsym_table.count + 1) > lsym_table.size) { lsym_grow(); }
+
+    unsigned long j = lsym_hash(s) & (lsym_table.size-1);
+    while (lsym_table.names[j]) {
+        if (strcmp(lsym_table.names[j], s) == 0) {
+            return lsym_table.names[j];
+        }
+        j = (j+1) & (lsym_table.size-1);
+    }
+
+    lsym_table.names[j] = malloc(strlen(s) + 1);
+    strcpy(lsym_table.names[j], s);
+    lsym_table.count++;
+    return lsym_table.names[j];
+}
 
 
 /* Lisp Value */
 
-enum { LVAL_ERR, LVAL_NUM, LVAL_SYM, LVAL_FUNC, LVAL_SEXPR, LVAL_QEXPR };
+enum { LVAL_ERR, LVAL_NUM, LVAL_SYM, LVAL_FUNC, LVAL_SEXPR, LVAL_QEXPR,
+       LVAL_FLOAT, LVAL_VEC, LVAL_STR, LVAL_TYPE_COUNT };
 
 typedef lval*(*lbuiltin)(lenv*, lval*);
 
-/* Declare new lval struct */
-struct lval {
-    int type;
-    long num;
-    char* err;
-    char* sym;
-    lbuiltin func;
+/* A lambda, called like a builtin with the environment and its argument
+   list. Each call binds the arguments in a new frame whose parent is the
+   frame the lambda was defined in. The body is compiled once with every
+   parameter reference resolved to a (depth, index) pair into that chain
+   of frames. */
+struct lfunc {
+    lval* formals;
+    lval* body;
+    lenv* env;
+    /* Parameter names in frame order, the last collecting any extra
+       arguments if the formals end with '& name' */
     int count;
-    lval** cell;
+    char** params;
+    int variadic;
+    lchunk* code;
 };
 
-/* Construct a pointer to a new Number lval */
-lval* lval_num(long x) {
-    lval* v = malloc(sizeof(lval));
-    v->type = LVAL_NUM;
-    v->num = x;
-    return v;
+/* Declare new lval struct. Only one member of the union is ever live for a
+   given type, which keeps each value at 24 bytes on 64-bit platforms.
+
+   The children of an S or Q-expression are held in a vector with room for
+   'cap' cells from 'cell' onwards. Popping from the front advances 'cell'
+   rather than moving the rest down, and 'start' counts the cells skipped
+   since the start of the allocation. A list marked LVAL_VIEW instead sees
+   'count' cells of an lslice shared with other lists, 'cap' cells in.
+
+   A symbol caches the slot it was last found at in the global environment,
+   valid while 'version' matches that environment's version. A Number too
+   big for 'num' has its digits in 'limbs'. A Vector packs 'len' integers
+   contiguously in 'ints'. A String is either in 'chars' or part of the
+   text in 'str'. */
+struct lval {
+    uint8_t type;
+    uint8_t flags;
+    uint16_t start;
+    int refs;
+    union {
+        long num;
+        struct {
+            uint32_t* limbs;
+            int size;
+        };
+        struct {
+            int64_t* ints;
+            int len;
+        };
+        struct {
+            lstr* str;
+            int str_off;
+            int str_len;
+        };
+        char chars[16];
+        char* err;
+        struct {
+            char* sym;
+            int slot;
+            unsigned version;
+        };
+        struct {
+            lbuiltin func;
+            lfunc* lambda;
+        };
+        struct {
+            lval** cell;
+            int count;
+            int cap;
+        };
+    };
+};
+
+/* Lisp Value Allocation */
+
+/* Unless compiled with -DLISPC_USE_MALLOC, lvals are carved out of large
+   slabs and recycled through a free list per type instead of going through
+   malloc and free for every value. Slabs are never returned to the system. */
+#define LVAL_SLAB_SIZE 1024
+
+/* Compiled with -DLISPC_ARENA, the nursery of the collector below becomes
+   an arena for each evaluation at the REPL. Every value made while
+   evaluating, along with the cells of lists and the text of errors, is
+   bump allocated there and never collected until the result has been
+   printed. Values bound by lenv_put are promoted out of it as they are
+   bound. The one collection afterwards copies out whatever environments
+   still refer to and drops the rest of the arena without visiting it. */
+#if defined(LISPC_ARENA) && !defined(LISPC_GC)
+#define LISPC_GC
+#endif
+
+#if defined(LISPC_GC) && defined(LISPC_USE_MALLOC)
+#error "LISPC_GC sweeps the lval slabs and cannot be used with LISPC_USE_MALLOC"
+#endif
+
+/* Compiled with -DLISPC_GC, values are reclaimed by a generational tracing
+   collector instead of by reference counting. New values are bump allocated
+   in a nursery. Once LISPC_GC_NURSERY values have been allocated there, a
+   minor collection at the next safe point in the evaluator copies the
+   survivors into the slabs, which hold the old generation. A major
+   mark-and-sweep of the slabs follows once 'threshold' values have been
+   promoted since the last one. The same is asked for once young values
+   have malloc'd LISPC_GC_NURSERY_BYTES for their cells, limbs and text, or
+   old values 'byte_threshold' bytes, since a few long lists can own far
+   more memory than the values themselves. */
+#ifndef LISPC_GC_THRESHOLD
+#define LISPC_GC_THRESHOLD 100000
+#endif
+#ifndef LISPC_GC_NURSERY
+#define LISPC_GC_NURSERY 65536
+#endif
+#ifndef LISPC_GC_NURSERY_BYTES
+#define LISPC_GC_NURSERY_BYTES (4 << 20)
+#endif
+#ifndef LISPC_GC_BYTES
+#define LISPC_GC_BYTES (16 << 20)
+#endif
+
+/* State bits kept in the flags of each value. The LGC_ bits belong to the
+   collector, LVAL_COMPILED marks a list with bytecode in the VM cache,
+   LVAL_VIEW one whose cells are in an lslice, LVAL_BIG a big Number and
+   LVAL_INLINE a String held in the value. */
+enum { LGC_MARK = 1, LGC_YOUNG = 2, LGC_FORWARD = 4, LGC_REMEMBERED = 8,
+       LVAL_COMPILED = 16, LVAL_VIEW = 32, LVAL_BIG = 64, LVAL_INLINE = 128 };
+
+struct {
+    long allocated;
+    long threshold;
+    int pending;
+    int nslabs;
+    lval** slabs;
+    size_t bytes;
+    size_t byte_threshold;
+} lval_heap = { 0, LISPC_GC_THRESHOLD, 0, 0, NULL, 0, LISPC_GC_BYTES };
+
+lval* lval_free_list[LVAL_TYPE_COUNT];
+
+/* Check the result of malloc or realloc, there being nothing to recover to */
+void* lval_checked(void* p) {
+    if (p == NULL) {
+        fputs("Out of memory\n", stderr);
+        abort();
+    }
+    return p;
 }
 
-/* Construct a pointer to a new Error lval */
-lval* lval_err(char* fmt, ...) {
-    lval* v = malloc(sizeof(lval));
-    v->type = LVAL_ERR;
+lval* lval_slab_alloc(int type) {
+    lval* v = lval_free_list[type];
 
-    /* Create a va list and initialize it */
-    va_list va;
-    va_start(va, fmt);
+    /* A list retyped in place is freed to its new type's list, which can
+       leave this one drained while another grows, so take over any other
+       list before asking for more memory */
+    for (int t = 0; v == NULL && t < LVAL_TYPE_COUNT; t++) {
+        v = lval_free_list[t];
+        lval_free_list[t] = NULL;
+    }
 
-    v->err = malloc(512);
-    /* printf the error string with a maximum of 511 characters */
-    vsnprintf(v->err, 511, fmt, va);
+    if (v == NULL) {
+        /* Carve a fresh slab into the free list for this type */
+        lval* slab = lval_checked(malloc(sizeof(lval) * LVAL_SLAB_SIZE));
+        for (int i = 0; i < LVAL_SLAB_SIZE; i++) {
+            slab[i].type = type;
+            slab[i].refs = 0;
+            slab[i].cell = (lval**)&slab[i+1];
+        }
+        slab[LVAL_SLAB_SIZE-1].cell = NULL;
+        v = slab;
 
-    /* Reallocate to number of bytes actually used */
-    v->err = realloc(v->err, strlen(v->err)+1);
-    va_end(va);
+        /* Remember every slab so the collector can sweep them */
+        lval_heap.nslabs++;
+        lval_heap.slabs = realloc(lval_heap.slabs, sizeof(lval*) * lval_heap.nslabs);
+        lval_heap.slabs[lval_heap.nslabs-1] = slab;
+    }
+    lval_free_list[type] = (lval*)v->cell;
+    v->flags = 0;
+#ifdef LISPC_GC
+    if (++lval_heap.allocated > lval_heap.threshold) { lval_heap.pending = 1; }
+#endif
+    v->type = type;
+    v->refs = 1;
     return v;
 }
 
-/* Construct a pointer to a new Symbol lval */
-lval* lval_sym(char* s) {
-    lval* v = malloc(sizeof(lval));
-    v->type = LVAL_SYM;
-    v->sym = malloc(strlen(s) + 1);
-    strcpy(v->sym, s);
-    return v;
+#ifdef LISPC_GC
+/* The nursery is a chain of chunks, the last of which is being filled */
+struct {
+    int used;
+    int count;
+    lval** chunks;
+    int pending;
+    size_t bytes;
+} lval_nursery;
+
+void lval_nursery_grow(void) {
+#ifndef LISPC_ARENA
+    /* Overflowing the first chunk asks for a minor collection */
+    if (lval_nursery.count > 0) { lval_nursery.pending = 1; }
+#endif
+
+    lval_nursery.count++;
+    lval_nursery.chunks = realloc(lval_nursery.chunks, sizeof(lval*) * lval_nursery.count);
+    lval_nursery.chunks[lval_nursery.count-1] =
+        lval_checked(malloc(sizeof(lval) * LISPC_GC_NURSERY));
+    lval_nursery.used = 0;
 }
 
-/* Construct a pointer to a new Function lval */
-lval* lval_func(lbuiltin func) {
-    lval* v = malloc(sizeof(lval));
-    v->type = LVAL_FUNC;
-    v->func = func;
-    return v;
+/* Whether a safe point in the evaluator should collect */
+int lgc_pending(void) {
+#ifdef LISPC_ARENA
+    /* The arena is only emptied between evaluations */
+    return 0;
+#else
+    return lval_nursery.pending || lval_heap.pending;
+#endif
 }
+#endif
 
-/* A pointer to a new empty Sexpr lval */
-lval* lval_sexpr(void) {
-    lval* v = malloc(sizeof(lval));
-    v->type = LVAL_SEXPR;
-    v->count = 0;
-    v->cell = NULL;
-    return v;
+#ifdef LISPC_ARENA
+/* Memory for young values is bump allocated from chunks of LARENA_CHUNK
+   bytes, or one of its own for anything larger. Lambdas, big Numbers and
+   long Strings are the only young values owning memory outside the arena,
+   so they are listed to be freed when it is emptied. */
+#define LARENA_CHUNK 65536
+
+struct {
+    int count;
+    size_t used;
+    size_t size;
+    char** chunks;
+    int nfinals;
+    int sfinals;
+    lval** finals;
+} larena;
+
+void* larena_alloc(size_t n) {
+    n = (n + 15) & ~(size_t)15;
+    if (larena.count == 0 || larena.used + n > larena.size) {
+        larena.size = n > LARENA_CHUNK ? n : LARENA_CHUNK;
+        larena.count++;
+        larena.chunks = realloc(larena.chunks, sizeof(char*) * larena.count);
+        larena.chunks[larena.count-1] = lval_checked(malloc(larena.size));
+        larena.used = 0;
+    }
+    void* p = larena.chunks[larena.count-1] + larena.used;
+    larena.used += n;
+    return p;
 }
 
-/* A pointer to a new empty Qexpr lval */
-lval* lval_qexpr(void) {
-    lval* v = malloc(sizeof(lval));
-    v->type = LVAL_QEXPR;
-    v->count = 0;
-    v->cell = NULL;
-    return v;
+void larena_final(lval* v) {
+    if (larena.nfinals == larena.sfinals) {
+        larena.sfinals = larena.sfinals ? larena.sfinals * 2 : 64;
+        larena.finals = realloc(larena.finals, sizeof(lval*) * larena.sfinals);
+    }
+    larena.finals[larena.nfinals++] = v;
 }
 
-/* Delete lval and free all allocated memory */
-void lval_del(lval* v) {
-    switch (v->type) {
-        case LVAL_FUNC: break;
-        case LVAL_NUM: break;
-        case LVAL_ERR: free(v->err); break;
-        case LVAL_SYM: free(v->sym); break;
-        case LVAL_SEXPR:
-        case LVAL_QEXPR:
-            for (int i = 0; i < v->count; i++) {
-                lval_del(v->cell[i]);
-            }
-            free(v->cell);
-        break;
+/* Free every chunk at once. Nothing may refer to the arena any more. */
+void larena_reset(void) {
+    for (int i = 0; i < larena.count; i++) {
+        free(larena.chunks[i]);
     }
+    larena.count = 0;
+    larena.nfinals = 0;
+}
+#endif
+
+lval* lval_alloc(int type) {
+#if defined(LISPC_USE_MALLOC)
+    lval* v = lval_checked(malloc(sizeof(lval)));
+    v->type = type;
+    v->flags = 0;
+    v->refs = 1;
+    return v;
+#elif defined(LISPC_GC)
+    /* Bump allocate in the nursery */
+    if (lval_nursery.count == 0 || lval_nursery.used == LISPC_GC_NURSERY) {
+        lval_nursery_grow();
+    }
+    lval* v = &lval_nursery.chunks[lval_nursery.count-1][lval_nursery.used++];
+    v->type = type;
+    v->refs = 1;
+    v->flags = LGC_YOUNG;
+    return v;
+#else
+    return lval_slab_alloc(type);
+#endif
+}
+
+void lval_free(lval* v) {
+#ifdef LISPC_USE_MALLOC
     free(v);
+#else
+#ifdef LISPC_GC
+    /* Nursery space is only reclaimed wholesale by a minor collection */
+    if (v->flags & LGC_YOUNG) {
+        v->refs = 0;
+        return;
+    }
+#endif
+    /* Thread the value onto the free list through its cell pointer */
+    v->refs = 0;
+    v->cell = (lval**)lval_free_list[v->type];
+    lval_free_list[v->type] = v;
+#endif
 }
 
-lval* lval_copy(lval* v) {
-    lval* x = malloc(sizeof(lval));
-    x->type = v->type;
+/* Count 'n' bytes malloc'd for what value 'v' owns towards the next
+   collection of its generation */
+void lval_owns(lval* v, size_t n) {
+#ifdef LISPC_GC
+    if (v->flags & LGC_YOUNG) {
+#ifndef LISPC_ARENA
+        lval_nursery.bytes += n;
+        if (lval_nursery.bytes > LISPC_GC_NURSERY_BYTES) { lval_nursery.pending = 1; }
+#endif
+    } else {
+        lval_heap.bytes += n;
+        if (lval_heap.bytes > lval_heap.byte_threshold) { lval_heap.pending = 1; }
+    }
+#endif
+}
 
-    switch (v->type) {
-        /* Copy functions and numbers directly */
-        case LVAL_FUNC: x->func = v->func; break;
-        case LVAL_NUM:  x->num  = v->num; break;
+/* 'n' bytes for value 'v' to own. malloc(0) may return NULL, which would
+   read as running out, so at least one byte is always asked for. */
+void* lval_malloc(lval* v, size_t n) {
+    lval_owns(v, n);
+    return lval_checked(malloc(n > 0 ? n : 1));
+}
 
-        /* Copy strings using malloc and strcpy */
-        case LVAL_ERR:
-            x->err = malloc(strlen(v->err) + 1);
-            strcpy(x->sym, v->sym); break;
+/* Doubles and small integers are stored directly in the lval pointer word
+   rather than on the heap, NaN-boxed the way JavaScriptCore does it. Heap
+   pointers fit in 48 bits, so their top 16 bits are clear. A double is
+   stored with 2^49 added to its bits, which moves it clear of pointers
+   below and of fixnums above, every NaN being made the one quiet NaN first
+   so none can wrap around. A fixnum has the top 15 bits set and its value
+   in the 49 bits below them. */
+#if UINTPTR_MAX != 0xFFFFFFFFFFFFFFFFu
+#error "Lispc needs 64-bit pointers to NaN-box values"
+#endif
 
-        case LVAL_SYM:
-            x->sym = malloc(strlen(v->sym) + 1);
-            strcpy(x->sym, v->sym); break;
+#define LVAL_TAG_FIXNUM 0xFFFE000000000000u
+#define LVAL_DOUBLE_OFFSET 0x0002000000000000u
+#define LVAL_QUIET_NAN 0x7FF8000000000000u
+#define LVAL_FIXNUM_MIN (-((int64_t)1 << 48))
+#define LVAL_FIXNUM_MAX (((int64_t)1 << 48) - 1)
+#define LVAL_FIXNUM_GET(v) ((long)((int64_t)((uint64_t)(uintptr_t)(v) << 15) >> 15))
 
-        /* Copy lists by copying each sub-expression */
-        case LVAL_SEXPR:
-        case LVAL_QEXPR:
-            x->count = v->count;
-            x->cell = malloc(sizeof(lval*) * x->count);
-            for (int i = 0; i < x->count; i++) {
-                x->cell[i] = lval_copy(v->cell[i]);
-            }
-        break;
-    }
-    return x;
+/* Whether 'v' is a value in itself rather than a pointer to the heap */
+int lval_is_imm(lval* v) {
+    return ((uintptr_t)v >> 49) != 0;
 }
 
-lval* lval_add(lval* v, lval* x) {
-    v->count++;
-    v->cell = realloc(v->cell, sizeof(lval*) * v->count);
-    v->cell[v->count-1] = x;
-    return v;
+int lval_is_fixnum(lval* v) {
+    return ((uintptr_t)v & LVAL_TAG_FIXNUM) == LVAL_TAG_FIXNUM;
 }
 
-lval* lval_join(lval* x, lval* y) {
-    /* For each cell in 'y' add it to 'x' */
-    for (int i = 0; i < y->count; i++) {
-        x = lval_add(x, y->cell[i]);
-    }
-    free(y->cell);
-    free(y);
-    return x;
+/* Type of any lval, immediate or boxed */
+int lval_type(lval* v) {
+    if (!lval_is_imm(v)) { return v->type; }
+    return lval_is_fixnum(v) ? LVAL_NUM : LVAL_FLOAT;
 }
 
-lval* lval_pop(lval* v, int i) {
-    /* Find the item at 'i' */
-    lval* x = v->cell[i];
+/* Whether 'v' is a Number or a Float */
+int lval_is_number(lval* v) {
+    int t = lval_type(v);
+    return t == LVAL_NUM || t == LVAL_FLOAT;
+}
 
-    /* Shift memory after the item at 'i' over the top */
-    memmove(&v->cell[i], &v->cell[i+1], sizeof(lval*) * (v->count-i-1));
+/* Numeric value of a Number lval, immediate or boxed, if it is not big */
+long lval_num_get(lval* v) {
+    return lval_is_imm(v) ? LVAL_FIXNUM_GET(v) : v->num;
+}
 
-    /* Decrease the count of items in the list */
-    v->count--;
+/* Construct a Number lval, only touching the heap when out of fixnum range */
+lval* lval_num(long x) {
+    if (x >= LVAL_FIXNUM_MIN && x <= LVAL_FIXNUM_MAX) {
+        return (lval*)(uintptr_t)(LVAL_TAG_FIXNUM | ((uint64_t)x & ~LVAL_TAG_FIXNUM));
+    }
+    lval* v = lval_alloc(LVAL_NUM);
+    v->num = x;
+    return v;
+}
 
-    /* Reallocate the memory used */
-    v->cell = realloc(v->cell, sizeof(lval*) * v->count);
-    return x;
+/* Construct a Float lval, which never touches the heap */
+lval* lval_float(double x) {
+    uint64_t bits = LVAL_QUIET_NAN;
+    if (x == x) { memcpy(&bits, &x, sizeof(bits)); }
+    return (lval*)(uintptr_t)(bits + LVAL_DOUBLE_OFFSET);
 }
 
-lval* lval_take(lval* v, int i) {
-    lval* x = lval_pop(v, i);
-    lval_del(v);
+double lval_float_get(lval* v) {
+    uint64_t bits = (uintptr_t)v - LVAL_DOUBLE_OFFSET;
+    double x;
+    memcpy(&x, &bits, sizeof(x));
     return x;
 }
 
-void lval_print(lval* v);
 
-void lval_expr_print(lval* v, char open, char close) {
-    putchar(open);
-    for (int i = 0; i < v->count; i++) {
-        lval_print(v->cell[i]);
-        /* Don't print trailing space if last element */
-        if (i != (v->count-1)) {
-            putchar(' ');
-        }
+/* Big Numbers */
+
+/* A Number outside the range of a long is boxed with LVAL_BIG set in its
+   flags, its magnitude held in 'size' 32-bit limbs, least significant
+   first, and the sign in that of 'size'. Results are stored as plain
+   Numbers whenever they fit, so a big Number never fits a long.
+
+   Arithmetic works on lbigs, which own their limbs. Magnitudes are passed
+   around as a limb pointer and length, with no zero limbs at the top once
+   trimmed. */
+typedef struct {
+    uint32_t* d;
+    int n;
+    int neg;
+} lbig;
+
+/* Operands of at least this many limbs are multiplied by Karatsuba's
+   method, smaller ones limb by limb */
+int lbig_karatsuba = 32;
+
+int lbig_is(lval* v) {
+    return !lval_is_imm(v) && (v->flags & LVAL_BIG);
+}
+
+int lmag_trim(uint32_t* a, int n) {
+    while (n > 0 && a[n-1] == 0) { n--; }
+    return n;
+}
+
+int lmag_cmp(uint32_t* a, int an, uint32_t* b, int bn) {
+    if (an != bn) { return an < bn ? -1 : 1; }
+    for (int i = an-1; i >= 0; i--) {
+        if (a[i] != b[i]) { return a[i] < b[i] ? -1 : 1; }
     }
-    putchar(close);
+    return 0;
 }
 
-void lval_print(lval* v) {
-    switch (v->type) {
-        case LVAL_FUNC:     printf("<function>"); break;
-        case LVAL_NUM:      printf("%li", v->num); break;
-        case LVAL_ERR:      printf("Error: %s", v->err); break;
-        case LVAL_SYM:      printf("%s", v->sym); break;
-        case LVAL_SEXPR:    lval_expr_print(v, '(', ')'); break;
-        case LVAL_QEXPR:    lval_expr_print(v, '{', '}'); break;
+/* r = a + b, with room in 'r' for one limb more than the longer */
+int lmag_add(uint32_t* r, uint32_t* a, int an, uint32_t* b, int bn) {
+    if (an < bn) {
+        uint32_t* t = a; a = b; b = t;
+        int tn = an; an = bn; bn = tn;
     }
+    uint64_t carry = 0;
+    for (int i = 0; i < an; i++) {
+        carry += (uint64_t)a[i] + (i < bn ? b[i] : 0);
+        r[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    r[an] = (uint32_t)carry;
+    return lmag_trim(r, an+1);
 }
 
-/* Print an lval followed by a newline */
-void lval_println(lval* v) { lval_print(v); putchar('\n'); }
+/* r = a - b where a >= b, with room in 'r' for 'an' limbs */
+int lmag_sub(uint32_t* r, uint32_t* a, int an, uint32_t* b, int bn) {
+    int64_t borrow = 0;
+    for (int i = 0; i < an; i++) {
+        int64_t d = (int64_t)a[i] - (i < bn ? b[i] : 0) - borrow;
+        borrow = d < 0;
+        r[i] = (uint32_t)d;
+    }
+    return lmag_trim(r, an);
+}
 
-char* ltype_name(int t) {
-    switch (t) {
-        case LVAL_FUNC: return "Function";
-        case LVAL_NUM: return "Number";
-        case LVAL_ERR: return "Error";
-        case LVAL_SYM: return "Symbol";
-        case LVAL_SEXPR: return "S-Expression";
-        case LVAL_QEXPR: return "Q-Expression";
-        default: return "Unknown";
+/* Add 't' into 'r', 'at' limbs up, carrying as far as needed */
+void lmag_add_at(uint32_t* r, int rn, int at, uint32_t* t, int tn) {
+    uint64_t carry = 0;
+    int i = 0;
+    for (; i < tn || (carry && at+i < rn); i++) {
+        carry += (uint64_t)r[at+i] + (i < tn ? t[i] : 0);
+        r[at+i] = (uint32_t)carry;
+        carry >>= 32;
     }
 }
 
+/* r = a * b, with room in 'r' for 'an + bn' limbs */
+void lmag_mul(uint32_t* r, uint32_t* a, int an, uint32_t* b, int bn) {
+    if (an < bn) {
+        uint32_t* t = a; a = b; b = t;
+        int tn = an; an = bn; bn = tn;
+    }
+    memset(r, 0, sizeof(uint32_t) * (an + bn));
+    if (bn == 0) { return; }
 
-/* Lisp Environment */
+    if (bn < lbig_karatsuba) {
+        for (int i = 0; i < bn; i++) {
+            uint64_t carry = 0;
+            for (int j = 0; j < an; j++) {
+                carry += (uint64_t)b[i] * a[j] + r[i+j];
+                r[i+j] = (uint32_t)carry;
+                carry >>= 32;
+            }
+            r[i+an] = (uint32_t)carry;
+        }
+        return;
+    }
 
-struct lenv {
-    int count;
-    char** syms;
-    lval** vals;
-};
+    /* A much longer 'a' is taken in pieces the length of 'b' */
+    if (2 * bn <= an) {
+        uint32_t* t = malloc(sizeof(uint32_t) * 2 * bn);
+        for (int i = 0; i < an; i += bn) {
+            int k = an - i < bn ? an - i : bn;
+            lmag_mul(t, a + i, k, b, bn);
+            lmag_add_at(r, an + bn, i, t, k + bn);
+        }
+        free(t);
+        return;
+    }
 
-lenv* lenv_new(void) {
-    lenv* e = malloc(sizeof(lenv));
-    e->count = 0;
-    e->syms = NULL;
-    e->vals = NULL;
-    return e;
+    /* Split both at 'm' limbs, a = a1 B^m + a0 and b = b1 B^m + b0. Then
+       ab = z2 B^2m + (z1 - z2 - z0) B^m + z0, where z0 = a0 b0, z2 = a1 b1
+       and z1 = (a0 + a1)(b0 + b1), three half size products in all. */
+    int m = an / 2;
+    lmag_mul(r, a, m, b, m);
+    lmag_mul(r + 2*m, a + m, an - m, b + m, bn - m);
+
+    uint32_t* sa = malloc(sizeof(uint32_t) * (an - m + 1));
+    uint32_t* sb = malloc(sizeof(uint32_t) * (an - m + 1));
+    int san = lmag_add(sa, a, lmag_trim(a, m), a + m, an - m);
+    int sbn = lmag_add(sb, b, lmag_trim(b, m), b + m, bn - m);
+
+    uint32_t* z1 = malloc(sizeof(uint32_t) * (san + sbn + 1));
+    lmag_mul(z1, sa, san, sb, sbn);
+    int z1n = lmag_trim(z1, san + sbn);
+    z1n = lmag_sub(z1, z1, z1n, r, lmag_trim(r, 2*m));
+    z1n = lmag_sub(z1, z1, z1n, r + 2*m, lmag_trim(r + 2*m, an + bn - 2*m));
+    lmag_add_at(r, an + bn, m, z1, z1n);
+
+    free(sa);
+    free(sb);
+    free(z1);
 }
 
-void lenv_del(lenv* e) {
-    for (int i = 0; i < e->count; i++) {
-        free(e->syms[i]);
-        lval_del(e->vals[i]);
+/* q = a / b and r = a % b for nonzero 'b', with room in 'q' for
+   'an - bn + 1' limbs and in 'r' for 'bn'. This is Knuth's algorithm D,
+   estimating each limb of the quotient from the top two of the remainder
+   and the top one of the divisor, scaled so that its top bit is set. */
+void lmag_divmod(uint32_t* q, int* qn, uint32_t* r, int* rn,
+        uint32_t* a, int an, uint32_t* b, int bn) {
+    if (an < bn) {
+        *qn = 0;
+        for (int i = 0; i < an; i++) { r[i] = a[i]; }
+        *rn = an;
+        return;
     }
-    free(e->syms);
-    free(e->vals);
-    free(e);
+
+    if (bn == 1) {
+        uint64_t rem = 0;
+        for (int i = an-1; i >= 0; i--) {
+            uint64_t cur = (rem << 32) | a[i];
+            q[i] = (uint32_t)(cur / b[0]);
+            rem = cur % b[0];
+        }
+        *qn = lmag_trim(q, an);
+        r[0] = (uint32_t)rem;
+        *rn = lmag_trim(r, 1);
+        return;
+    }
+
+    int s = 0;
+    while (!((b[bn-1] << s) & 0x80000000u)) { s++; }
+
+    uint32_t* vn = malloc(sizeof(uint32_t) * bn);
+    uint32_t* un = malloc(sizeof(uint32_t) * (an + 1));
+    for (int i = bn-1; i > 0; i--) {
+        vn[i] = (b[i] << s) | (uint32_t)((uint64_t)b[i-1] >> (32 - s));
+    }
+    vn[0] = b[0] << s;
+    un[an] = (uint32_t)((uint64_t)a[an-1] >> (32 - s));
+    for (int i = an-1; i > 0; i--) {
+        un[i] = (a[i] << s) | (uint32_t)((uint64_t)a[i-1] >> (32 - s));
+    }
+    un[0] = a[0] << s;
+
+    const uint64_t base = (uint64_t)1 << 32;
+    for (int j = an - bn; j >= 0; j--) {
+        uint64_t top = ((uint64_t)un[j+bn] << 32) | un[j+bn-1];
+        uint64_t qhat = top / vn[bn-1];
+        uint64_t rhat = top % vn[bn-1];
+        while (qhat >= base || qhat * vn[bn-2] > ((rhat << 32) | un[j+bn-2])) {
+            qhat--;
+            rhat += vn[bn-1];
+            if (rhat >= base) { break; }
+        }
+
+        /* Subtract qhat times the divisor, adding it back once if that
+           went below zero */
+        int64_t k = 0, t;
+        for (int i = 0; i < bn; i++) {
+            uint64_t p = qhat * vn[i];
+            t = (int64_t)un[i+j] - k - (int64_t)(p & 0xFFFFFFFFu);
+            un[i+j] = (uint32_t)t;
+            k = (int64_t)(p >> 32) - (t >> 32);
+        }
+        t = (int64_t)un[j+bn] - k;
+        un[j+bn] = (uint32_t)t;
+
+        q[j] = (uint32_t)qhat;
+        if (t < 0) {
+            q[j]--;
+            uint64_t c = 0;
+            for (int i = 0; i < bn; i++) {
+                c += (uint64_t)un[i+j] + vn[i];
+                un[i+j] = (uint32_t)c;
+                c >>= 32;
+            }
+            un[j+bn] += (uint32_t)c;
+        }
+    }
+
+    for (int i = 0; i < bn; i++) {
+        r[i] = (un[i] >> s) | (uint32_t)((uint64_t)un[i+1] << (32 - s));
+    }
+    *qn = lmag_trim(q, an - bn + 1);
+    *rn = lmag_trim(r, bn);
+    free(vn);
+    free(un);
 }
 
-lval* lenv_get(lenv* e, lval* k) {
-    /* Iterate over all items in environment */
-    for (int i = 0; i < e->count; i++) {
-        /* Check if the stores string matches the symbol string */
-        /* If it does, return a copy of the value */
-        if (strcmp(e->syms[i], k->sym) == 0) {
-            return lval_copy(e->vals[i]);
+lbig lbig_alloc(int n) {
+    lbig x = { malloc(sizeof(uint32_t) * (n > 0 ? n : 1)), 0, 0 };
+    return x;
+}
+
+lbig lbig_from_long(long v) {
+    lbig x = lbig_alloc(2);
+    /* Negate as unsigned so that LONG_MIN has a magnitude too */
+    uint64_t m = v < 0 ? 0 - (uint64_t)v : (uint64_t)v;
+    x.d[0] = (uint32_t)m;
+    x.d[1] = (uint32_t)(m >> 32);
+    x.n = lmag_trim(x.d, 2);
+    x.neg = v < 0;
+    return x;
+}
+
+/* A copy of any Number */
+lbig lbig_of(lval* v) {
+    if (!lbig_is(v)) { return lbig_from_long(lval_num_get(v)); }
+    int n = v->size < 0 ? -v->size : v->size;
+    lbig x = lbig_alloc(n);
+    memcpy(x.d, v->limbs, sizeof(uint32_t) * n);
+    x.n = n;
+    x.neg = v->size < 0;
+    return x;
+}
+
+/* A Number for 'x', which it takes */
+lval* lval_big(lbig x) {
+    if (x.n <= 2) {
+        uint64_t m = x.n == 0 ? 0 : x.d[0] | (x.n == 2 ? (uint64_t)x.d[1] << 32 : 0);
+        if (m <= (uint64_t)LONG_MAX || (x.neg && m == (uint64_t)LONG_MAX + 1)) {
+            free(x.d);
+            return lval_num(x.neg ? (long)(0 - m) : (long)m);
         }
     }
-    /* If no symbol is found, return an error msg */
-    return lval_err("Unbound symbol '%s'", k->sym);
+
+    lval* v = lval_alloc(LVAL_NUM);
+    v->flags |= LVAL_BIG;
+    v->limbs = x.d;
+    v->size = x.neg ? -x.n : x.n;
+    lval_owns(v, sizeof(uint32_t) * x.n);
+#ifdef LISPC_ARENA
+    larena_final(v);
+#endif
+    return v;
 }
 
-void lenv_put(lenv* e, lval* k, lval* v) {
-    /* Iterate over all items in environment */
-    for (int i = 0; i < e->count; i++) {
-        /* If variable is found, delete and replace with new value */
-        if (strcmp(e->syms[i], k->sym) == 0) {
-            lval_del(e->vals[i]);
-            e->vals[i] = lval_copy(v);
-            return;
+/* a + b, or a - b if 'sub' is set, freeing neither */
+lbig lbig_add(lbig a, lbig b, int sub) {
+    int bneg = b.neg ^ sub;
+    lbig r = lbig_alloc((a.n > b.n ? a.n : b.n) + 1);
+    if (a.neg == bneg) {
+        r.n = lmag_add(r.d, a.d, a.n, b.d, b.n);
+        r.neg = a.neg;
+    } else if (lmag_cmp(a.d, a.n, b.d, b.n) >= 0) {
+        r.n = lmag_sub(r.d, a.d, a.n, b.d, b.n);
+        r.neg = a.neg;
+    } else {
+        r.n = lmag_sub(r.d, b.d, b.n, a.d, a.n);
+        r.neg = bneg;
+    }
+    if (r.n == 0) { r.neg = 0; }
+    return r;
+}
+
+/* Less than, equal to or greater than zero as 'a' is to 'b' */
+int lbig_cmp(lbig a, lbig b) {
+    if (a.neg != b.neg) { return a.neg ? -1 : 1; }
+    int c = lmag_cmp(a.d, a.n, b.d, b.n);
+    return a.neg ? -c : c;
+}
+
+lbig lbig_mul(lbig a, lbig b) {
+    lbig r = lbig_alloc(a.n + b.n);
+    lmag_mul(r.d, a.d, a.n, b.d, b.n);
+    r.n = lmag_trim(r.d, a.n + b.n);
+    r.neg = r.n > 0 && a.neg != b.neg;
+    return r;
+}
+
+/* a / b or a % b for nonzero 'b', truncating like C does */
+lbig lbig_div(lbig a, lbig b, int mod) {
+    lbig q = lbig_alloc(a.n - b.n + 1);
+    lbig r = lbig_alloc(b.n);
+    lmag_divmod(q.d, &q.n, r.d, &r.n, a.d, a.n, b.d, b.n);
+    q.neg = q.n > 0 && a.neg != b.neg;
+    r.neg = r.n > 0 && a.neg;
+    free(mod ? q.d : r.d);
+    return mod ? r : q;
+}
+
+/* Read a decimal integer of any length */
+lbig lbig_read(char* s) {
+    int neg = *s == '-';
+    if (neg) { s++; }
+
+    int len = strlen(s);
+    lbig x = lbig_alloc(len / 9 + 2);
+    x.n = 0;
+    /* Take nine digits at a time: x = x * 10^k + digits */
+    for (int i = 0; i < len; ) {
+        uint32_t chunk = 0, scale = 1;
+        for (int k = 0; k < 9 && i < len; k++, i++) {
+            chunk = chunk * 10 + (s[i] - '0');
+            scale *= 10;
+        }
+        uint64_t carry = chunk;
+        for (int j = 0; j < x.n; j++) {
+            carry += (uint64_t)x.d[j] * scale;
+            x.d[j] = (uint32_t)carry;
+            carry >>= 32;
         }
+        if (carry) { x.d[x.n++] = (uint32_t)carry; }
     }
+    x.neg = neg && x.n > 0;
+    return x;
+}
 
-    /* If no existing entry found, add new entry to environment */
-    e->count++;
-    e->vals = realloc(e->vals, sizeof(lval*) * e->count);
-    e->syms = realloc(e->syms, sizeof(char*) * e->count);
+/* Print a big Number in decimal, nine digits at a time from the bottom */
+void lval_big_print(lval* v) {
+    lbig x = lbig_of(v);
+    uint32_t* chunks = malloc(sizeof(uint32_t) * (x.n * 10 / 9 + 2));
+    int count = 0;
+    do {
+        uint64_t rem = 0;
+        for (int i = x.n-1; i >= 0; i--) {
+            uint64_t cur = (rem << 32) | x.d[i];
+            x.d[i] = (uint32_t)(cur / 1000000000u);
+            rem = cur % 1000000000u;
+        }
+        chunks[count++] = (uint32_t)rem;
+        x.n = lmag_trim(x.d, x.n);
+    } while (x.n > 0);
 
-    /* Copy contents of lval and symbol string into new location */
-    e->vals[e->count-1] = lval_copy(v);
-    e->syms[e->count-1] = malloc(strlen(k->sym) + 1);
-    strcpy(e->syms[e->count-1], k->sym);
+    if (x.neg) { putchar('-'); }
+    printf("%u", chunks[count-1]);
+    for (int i = count-2; i >= 0; i--) { printf("%09u", chunks[i]); }
+    free(chunks);
+    free(x.d);
+}
+
+/* The nearest double to any Number or Float */
+double lval_float_of(lval* v) {
+    if (lval_type(v) == LVAL_FLOAT) { return lval_float_get(v); }
+    if (!lbig_is(v)) { return (double)lval_num_get(v); }
+
+    int n = v->size < 0 ? -v->size : v->size;
+    double x = 0;
+    for (int i = n-1; i >= 0; i--) { x = x * 4294967296.0 + v->limbs[i]; }
+    return v->size < 0 ? -x : x;
+}
+
+/* Print the fewest digits that read back as the same double, in positional
+   form unless the exponent is large, and with a point or exponent in it so
+   that it reads back as a Float */
+void lval_float_print(double x) {
+    char buf[40];
+    int p = 1;
+    for (; p < 17; p++) {
+        snprintf(buf, sizeof(buf), "%.*e", p-1, x);
+        if (strtod(buf, NULL) == x) { break; }
+    }
+    snprintf(buf, sizeof(buf), "%.*e", p-1, x);
+
+    if (isfinite(x)) {
+        int exp = atoi(strchr(buf, 'e') + 1);
+        if (exp >= -5 && exp < 17) {
+            snprintf(buf, sizeof(buf), "%.*f", p-1-exp > 0 ? p-1-exp : 0, x);
+        }
+    }
+    fputs(buf, stdout);
+    if (isfinite(x) && !strpbrk(buf, ".e")) { fputs(".0", stdout); }
+}
+
+/* Construct a pointer to a new Error lval */
+lval* lval_err(char* fmt, ...) {
+    lval* v = lval_alloc(LVAL_ERR);
+
+    /* Create a va list and initialize it */
+    va_list va;
+    va_start(va, fmt);
+
+#ifdef LISPC_ARENA
+    /* Format on the stack, then keep just the bytes used in the arena */
+    char buf[512];
+    vsnprintf(buf, 511, fmt, va);
+    v->err = larena_alloc(strlen(buf)+1);
+    strcpy(v->err, buf);
+#else
+    v->err = lval_checked(malloc(512));
+    /* printf the error string with a maximum of 511 characters */
+    vsnprintf(v->err, 511, fmt, va);
+
+    /* Reallocate to number of bytes actually used */
+    v->err = realloc(v->err, strlen(v->err)+1);
+    lval_owns(v, strlen(v->err)+1);
+#endif
+    va_end(va);
+    return v;
+}
+
+/* Construct a pointer to a new Symbol lval */
+lval* lval_sym(char* s) {
+    lval* v = lval_alloc(LVAL_SYM);
+    v->sym = lsym_intern(s);
+    v->version = 0;
+    return v;
+}
+
+/* Construct a pointer to a new Function lval */
+lval* lval_func(lbuiltin func) {
+    lval* v = lval_alloc(LVAL_FUNC);
+    v->func = func;
+    v->lambda = NULL;
+    return v;
+}
+
+/* A pointer to a new empty Sexpr lval */
+lval* lval_sexpr(void) {
+    lval* v = lval_alloc(LVAL_SEXPR);
+    v->start = 0;
+    v->count = 0;
+    v->cap = 0;
+    v->cell = NULL;
+    return v;
+}
+
+/* A pointer to a new empty Qexpr lval */
+lval* lval_qexpr(void) {
+    lval* v = lval_alloc(LVAL_QEXPR);
+    v->start = 0;
+    v->count = 0;
+    v->cap = 0;
+    v->cell = NULL;
+    return v;
+}
+
+int64_t* lval_ints(lval* v, int n);
+
+/* A pointer to a new Vector lval of 'n' integers, left uninitialised */
+lval* lval_vec(int n) {
+    lval* v = lval_alloc(LVAL_VEC);
+    v->len = n;
+    v->ints = lval_ints(v, n);
+    return v;
+}
+
+/* Strings */
+
+/* A string of at most LSTR_INLINE bytes is kept in the value itself, in
+   'chars' with its length in 'start', and marked LVAL_INLINE. A longer one
+   sees 'str_len' bytes from 'str_off' into an lstr, which any number of
+   strings may share. All are NUL terminated where they end in their text.
+
+   An lstr is flat, holding its bytes in 'data', or a rope joining 'left'
+   and 'right' that gets its 'data' the first time it is read, letting go
+   of its halves. Appending to a long string is then a matter of making a
+   node rather than copying what came before. */
+#define LSTR_INLINE 15
+
+struct lstr {
+    int refs;
+    int len;
+    char* data;
+    lstr* left;
+    lstr* right;
+};
+
+/* A flat lstr of 'n' bytes from 's', its data in the same allocation */
+lstr* lstr_new(const char* s, int n) {
+    lstr* t = malloc(sizeof(lstr) + n + 1);
+    t->refs = 1;
+    t->len = n;
+    t->data = (char*)(t + 1);
+    t->left = NULL;
+    t->right = NULL;
+    memcpy(t->data, s, n);
+    t->data[n] = '\0';
+    return t;
+}
+
+/* Ropes can be as deep as the appends that built them, so they are taken
+   apart and flattened with a stack of their own rather than by recursion */
+struct {
+    int count;
+    int size;
+    lstr** items;
+} lstr_stack;
+
+void lstr_push(lstr* t) {
+    if (lstr_stack.count == lstr_stack.size) {
+        lstr_stack.size = lstr_stack.size ? lstr_stack.size * 2 : 64;
+        lstr_stack.items = realloc(lstr_stack.items, sizeof(lstr*) * lstr_stack.size);
+    }
+    lstr_stack.items[lstr_stack.count++] = t;
+}
+
+/* Drop a reference to an lstr, freeing it and the halves it held with the
+   last */
+void lstr_del(lstr* t) {
+    int base = lstr_stack.count;
+    lstr_push(t);
+    while (lstr_stack.count > base) {
+        t = lstr_stack.items[--lstr_stack.count];
+        if (--t->refs > 0) { continue; }
+        if (t->left) {
+            lstr_push(t->left);
+            lstr_push(t->right);
+        }
+        if (t->data != (char*)(t + 1)) { free(t->data); }
+        free(t);
+    }
+}
+
+/* Give a rope its data, copying in the flat pieces from left to right */
+void lstr_flatten(lstr* t) {
+    if (t->data) { return; }
+    char* data = malloc(t->len + 1);
+    int at = 0;
+    int base = lstr_stack.count;
+    lstr_push(t);
+    while (lstr_stack.count > base) {
+        lstr* u = lstr_stack.items[--lstr_stack.count];
+        if (u->data) {
+            memcpy(data + at, u->data, u->len);
+            at += u->len;
+        } else {
+            lstr_push(u->right);
+            lstr_push(u->left);
+        }
+    }
+    data[at] = '\0';
+
+    t->data = data;
+    lstr_del(t->left);
+    lstr_del(t->right);
+    t->left = NULL;
+    t->right = NULL;
+}
+
+/* A string seeing 'n' bytes of 't' from 'off', taking the reference passed */
+lval* lval_str_of(lstr* t, int off, int n) {
+    lval* v = lval_alloc(LVAL_STR);
+    v->str = t;
+    v->str_off = off;
+    v->str_len = n;
+    lval_owns(v, n);
+#ifdef LISPC_ARENA
+    larena_final(v);
+#endif
+    return v;
+}
+
+/* A pointer to a new String lval holding a copy of 'n' bytes from 's' */
+lval* lval_str(const char* s, int n) {
+    if (n > LSTR_INLINE) { return lval_str_of(lstr_new(s, n), 0, n); }
+
+    lval* v = lval_alloc(LVAL_STR);
+    v->flags |= LVAL_INLINE;
+    v->start = n;
+    memcpy(v->chars, s, n);
+    v->chars[n] = '\0';
+    return v;
+}
+
+int lval_str_len(lval* v) {
+    return (v->flags & LVAL_INLINE) ? v->start : v->str_len;
+}
+
+/* The bytes of a string, flattening its text first if a rope */
+char* lval_str_data(lval* v) {
+    if (v->flags & LVAL_INLINE) { return v->chars; }
+    lstr_flatten(v->str);
+    return v->str->data + v->str_off;
+}
+
+/* The text of a long string as an lstr of its own, shared if the string
+   sees all of one */
+lstr* lval_str_text(lval* v) {
+    if (!(v->flags & LVAL_INLINE) && v->str_off == 0 && v->str_len == v->str->len) {
+        v->str->refs++;
+        return v->str;
+    }
+    return lstr_new(lval_str_data(v), lval_str_len(v));
+}
+
+lval* lval_copy(lval* v);
+void lval_del(lval* v);
+
+/* Append string 'y' to 'x', consuming 'x'. Short results are copied
+   inline, long ones are a rope over the two. */
+lval* lval_str_cat(lval* x, lval* y) {
+    int xn = lval_str_len(x), yn = lval_str_len(y);
+    if (yn == 0) { return x; }
+
+    lval* r;
+    if (xn + yn <= LSTR_INLINE) {
+        char buf[LSTR_INLINE + 1];
+        memcpy(buf, lval_str_data(x), xn);
+        memcpy(buf + xn, lval_str_data(y), yn);
+        r = lval_str(buf, xn + yn);
+    } else if (xn == 0) {
+        r = lval_copy(y);
+    } else {
+        lstr* t = malloc(sizeof(lstr));
+        t->refs = 1;
+        t->len = xn + yn;
+        t->data = NULL;
+        t->left = lval_str_text(x);
+        t->right = lval_str_text(y);
+        r = lval_str_of(t, 0, t->len);
+    }
+    lval_del(x);
+    return r;
+}
+
+/* Print a string as a literal that reads back as the same string */
+void lval_str_print(lval* v) {
+    char* s = lval_str_data(v);
+    int n = lval_str_len(v);
+    putchar('"');
+    for (int i = 0; i < n; i++) {
+        switch (s[i]) {
+            case '\a': fputs("\\a", stdout); break;
+            case '\b': fputs("\\b", stdout); break;
+            case '\f': fputs("\\f", stdout); break;
+            case '\n': fputs("\\n", stdout); break;
+            case '\r': fputs("\\r", stdout); break;
+            case '\t': fputs("\\t", stdout); break;
+            case '\v': fputs("\\v", stdout); break;
+            case '\\': fputs("\\\\", stdout); break;
+            case '"':  fputs("\\\"", stdout); break;
+            default:   putchar(s[i]); break;
+        }
+    }
+    putchar('"');
+}
+
+
+/* Nested lists are walked with an explicit stack of the lists entered and
+   the next child of each, never by recursion, so nesting depth is bounded
+   only by memory. A walk started inside another works above its entries.
+   Each entry has room for a mark of the walk's own, such as where output
+   for the list began. */
+struct {
+    int count;
+    int size;
+    struct { lval* v; int i; int mark; }* items;
+} lwalk;
+
+void lwalk_push(lval* v) {
+    if (lwalk.count == lwalk.size) {
+        lwalk.size = lwalk.size ? lwalk.size * 2 : 64;
+        lwalk.items = realloc(lwalk.items, sizeof(*lwalk.items) * lwalk.size);
+    }
+    lwalk.items[lwalk.count].v = v;
+    lwalk.items[lwalk.count].i = 0;
+    lwalk.items[lwalk.count].mark = 0;
+    lwalk.count++;
+}
+
+/* Memory for 'n' cells of list 'v' */
+lval** lval_cells(lval* v, int n) {
+#ifdef LISPC_ARENA
+    if (v->flags & LGC_YOUNG) { return larena_alloc(sizeof(lval*) * n); }
+#endif
+    return lval_malloc(v, sizeof(lval*) * n);
+}
+
+/* Memory for 'n' integers of vector 'v' */
+int64_t* lval_ints(lval* v, int n) {
+#ifdef LISPC_ARENA
+    if (v->flags & LGC_YOUNG) { return larena_alloc(sizeof(int64_t) * n); }
+#endif
+    return lval_malloc(v, sizeof(int64_t) * (n > 0 ? n : 1));
+}
+
+/* Values are immutable once shared. Each lval counts the references held
+   to it: lval_copy shares a value by taking another reference and lval_del
+   drops one, freeing the value along with the last. Code that mutates a
+   list must first make sure it holds the only reference via lval_unshare.
+
+   Under LISPC_GC the collector frees values, lval_del does nothing and the
+   count saturates at two, only recording whether a value is shared. */
+
+void lvm_forget(lval* v);
+void lfunc_del(lfunc* f);
+
+/* Free the memory owned by an lval, but not the values it refers to */
+void lval_finalize(lval* v) {
+    if (v->flags & LVAL_COMPILED) { lvm_forget(v); }
+
+#ifdef LISPC_ARENA
+    /* Anything else a young value owns is in the arena */
+    if (v->flags & LGC_YOUNG) {
+        if (v->type == LVAL_FUNC && v->lambda) { lfunc_del(v->lambda); }
+        if (v->flags & LVAL_BIG) { free(v->limbs); }
+        if (v->type == LVAL_STR && !(v->flags & LVAL_INLINE)) { lstr_del(v->str); }
+        return;
+    }
+#endif
+
+    switch (v->type) {
+        case LVAL_NUM: if (v->flags & LVAL_BIG) { free(v->limbs); } break;
+        case LVAL_ERR: free(v->err); break;
+        case LVAL_FUNC: if (v->lambda) { lfunc_del(v->lambda); } break;
+        case LVAL_VEC: free(v->ints); break;
+        case LVAL_STR: if (!(v->flags & LVAL_INLINE)) { lstr_del(v->str); } break;
+        case LVAL_SEXPR:
+        case LVAL_QEXPR:
+            /* The storage of a view is released by lval_del */
+            if (!(v->flags & LVAL_VIEW)) { free(v->cell - v->start); }
+        break;
+    }
+}
+
+/* Cells shared by views of a list, holding a reference to each value */
+typedef struct {
+    int refs;
+    int count;
+    lval* cell[];
+} lslice;
+
+lslice* lslice_of(lval* v) {
+    return (lslice*)((char*)(v->cell - v->cap) - offsetof(lslice, cell));
+}
+
+/* Drop a reference to lval and free all allocated memory with the last */
+void lval_del(lval* v) {
+#ifdef LISPC_GC
+    /* Left for the collector */
+    return;
+#endif
+    /* Immediate values own no memory */
+    if (lval_is_imm(v)) { return; }
+
+    if (--v->refs > 0) { return; }
+
+    /* Release the children of a list along with it, queueing those whose
+       last reference it held */
+    int base = lwalk.count;
+    lwalk_push(v);
+    while (lwalk.count > base) {
+        v = lwalk.items[--lwalk.count].v;
+        if (v->type == LVAL_SEXPR || v->type == LVAL_QEXPR) {
+            lval** cell = v->cell;
+            int count = v->count;
+
+            /* A view holds its storage rather than the values in it */
+            lslice* s = NULL;
+            if (v->flags & LVAL_VIEW) {
+                s = lslice_of(v);
+                cell = s->cell;
+                count = --s->refs == 0 ? s->count : 0;
+            }
+
+            for (int i = 0; i < count; i++) {
+                lval* x = cell[i];
+                if (!lval_is_imm(x) && --x->refs == 0) { lwalk_push(x); }
+            }
+            if (s && s->refs == 0) { free(s); }
+        }
+        lval_finalize(v);
+        lval_free(v);
+    }
+}
+
+/* Share an lval by taking another reference to it */
+lval* lval_copy(lval* v) {
+    /* Immediate values are plain words, so the copy is the word itself */
+    if (lval_is_imm(v)) { return v; }
+
+#ifdef LISPC_GC
+    v->refs = 2;
+#else
+    v->refs++;
+#endif
+    return v;
+}
+
+/* Whether others may see a change to list 'v' */
+int lval_shared(lval* v) {
+    return v->refs > 1 || (v->flags & LVAL_VIEW);
+}
+
+/* Return a list that is safe to mutate in place. If other references to
+   'v' exist, the reference passed in is exchanged for a fresh top level
+   list sharing the same children. */
+lval* lval_unshare(lval* v) {
+    if (!lval_shared(v)) {
+        /* Any cached bytecode is about to go stale */
+        if (v->flags & LVAL_COMPILED) { lvm_forget(v); }
+        return v;
+    }
+
+    lval* x = lval_alloc(v->type);
+    x->start = 0;
+    x->count = v->count;
+    x->cap = v->count;
+    x->cell = lval_cells(x, x->cap);
+    for (int i = 0; i < x->count; i++) {
+        x->cell[i] = lval_copy(v->cell[i]);
+    }
+    lval_del(v);
+    return x;
+}
+
+#ifdef LISPC_GC
+/* Old values that have had young values stored into them since the last
+   minor collection. Only lists still in flight in the evaluator are ever
+   mutated after promotion, so this stays small. */
+struct {
+    int count;
+    lval** vals;
+} lgc_remembered;
+
+/* Write barrier, called before young 'x' is stored into list 'v' */
+void lgc_barrier(lval* v, lval* x) {
+    if (v->flags & (LGC_YOUNG | LGC_REMEMBERED)) { return; }
+    if (lval_is_imm(x) || !(x->flags & LGC_YOUNG)) { return; }
+
+    v->flags |= LGC_REMEMBERED;
+    lgc_remembered.count++;
+    lgc_remembered.vals = realloc(lgc_remembered.vals, sizeof(lval*) * lgc_remembered.count);
+    lgc_remembered.vals[lgc_remembered.count-1] = v;
+}
+#endif
+
+/* Move the cells back to the start of their allocation */
+void lval_compact(lval* v) {
+    if (v->start == 0) { return; }
+    memmove(v->cell - v->start, v->cell, sizeof(lval*) * v->count);
+    v->cell -= v->start;
+    v->cap += v->start;
+    v->start = 0;
+}
+
+/* Make room for at least 'n' cells, growing the vector geometrically */
+void lval_reserve(lval* v, int n) {
+    if (n <= v->cap) { return; }
+
+    /* Reuse the space left by front pops before asking for more */
+    lval_compact(v);
+    if (n <= v->cap) { return; }
+
+    int cap = v->cap ? v->cap * 2 : 4;
+    if (cap < n) { cap = n; }
+#ifdef LISPC_ARENA
+    /* Cells in the arena are left behind rather than reallocated */
+    if (v->flags & LGC_YOUNG) {
+        lval** cell = lval_cells(v, cap);
+        for (int i = 0; i < v->count; i++) { cell[i] = v->cell[i]; }
+        v->cell = cell;
+        v->cap = cap;
+        return;
+    }
+#endif
+    lval_owns(v, sizeof(lval*) * (cap - v->cap));
+    v->cell = lval_checked(realloc(v->cell, sizeof(lval*) * cap));
+    v->cap = cap;
+}
+
+lval* lval_add(lval* v, lval* x) {
+#ifdef LISPC_GC
+    lgc_barrier(v, x);
+#endif
+    lval_reserve(v, v->count+1);
+    v->cell[v->count++] = x;
+    return v;
+}
+
+lval* lval_join(lval* x, lval* y) {
+    /* Size 'x' once for all of the cells in 'y' */
+    lval_reserve(x, x->count + y->count);
+
+    /* If 'y' is shared, add new references to its cells to 'x' */
+    if (lval_shared(y)) {
+        for (int i = 0; i < y->count; i++) {
+            x = lval_add(x, lval_copy(y->cell[i]));
+        }
+        lval_del(y);
+        return x;
+    }
+
+    /* Otherwise move each cell in 'y' over to 'x' */
+    for (int i = 0; i < y->count; i++) {
+        x = lval_add(x, y->cell[i]);
+    }
+    lval_finalize(y);
+    lval_free(y);
+    return x;
+}
+
+lval* lval_pop(lval* v, int i) {
+    /* Find the item at 'i' */
+    lval* x = v->cell[i];
+
+    if (i == 0) {
+        /* Step over the first item, compacting if the offset would overflow */
+        if (v->start == UINT16_MAX) { lval_compact(v); }
+        v->cell++;
+        v->cap--;
+        v->start++;
+    } else {
+        /* Shift memory after the item at 'i' over the top */
+        memmove(&v->cell[i], &v->cell[i+1], sizeof(lval*) * (v->count-i-1));
+    }
+
+    /* Decrease the count of items in the list */
+    v->count--;
+    return x;
+}
+
+lval* lval_take(lval* v, int i) {
+    /* A shared list is left intact, keeping a reference to the item */
+    if (lval_shared(v)) {
+        lval* x = lval_copy(v->cell[i]);
+        lval_del(v);
+        return x;
+    }
+
+    lval* x = lval_pop(v, i);
+    lval_del(v);
+    return x;
+}
+
+#ifndef LISPC_GC
+/* A new list seeing cells 'from' to 'to' of list 'v' without copying
+   them. The cells of 'v' are first moved into an lslice, once, unless 'v'
+   is already a view. Under LISPC_GC lists always own their cells. */
+lval* lval_slice(lval* v, int from, int to) {
+    if (!(v->flags & LVAL_VIEW)) {
+        lslice* s = malloc(sizeof(lslice) + sizeof(lval*) * v->count);
+        s->refs = 1;
+        s->count = v->count;
+        for (int i = 0; i < v->count; i++) { s->cell[i] = v->cell[i]; }
+        free(v->cell - v->start);
+
+        v->flags |= LVAL_VIEW;
+        v->cell = s->cell;
+        v->start = 0;
+        v->cap = 0;
+    }
+
+    lval* x = lval_alloc(v->type);
+    x->flags |= LVAL_VIEW;
+    x->start = 0;
+    x->cell = v->cell + from;
+    x->count = to - from;
+    x->cap = v->cap + from;
+    lslice_of(v)->refs++;
+    return x;
+}
+#endif
+
+void lval_print(lval* v);
+
+void lval_atom_print(lval* v) {
+    switch (lval_type(v)) {
+        case LVAL_FUNC:
+            if (v->lambda) {
+                printf("(\\ ");
+                lval_print(v->lambda->formals);
+                putchar(' ');
+                lval_print(v->lambda->body);
+                putchar(')');
+            } else {
+                printf("<function>");
+            }
+        break;
+        case LVAL_NUM:
+            if (lbig_is(v)) { lval_big_print(v); } else { printf("%li", lval_num_get(v)); }
+        break;
+        case LVAL_FLOAT:    lval_float_print(lval_float_get(v)); break;
+        case LVAL_STR:      lval_str_print(v); break;
+        case LVAL_VEC:
+            putchar('[');
+            for (int i = 0; i < v->len; i++) {
+                printf(i ? " %lli" : "%lli", (long long)v->ints[i]);
+            }
+            putchar(']');
+        break;
+        case LVAL_ERR:      printf("Error: %s", v->err); break;
+        case LVAL_SYM:      printf("%s", v->sym); break;
+    }
+}
+
+void lval_print(lval* v) {
+    int base = lwalk.count;
+    while (1) {
+        /* Open a list, or print anything else outright */
+        switch (lval_type(v)) {
+            case LVAL_SEXPR: putchar('('); lwalk_push(v); break;
+            case LVAL_QEXPR: putchar('{'); lwalk_push(v); break;
+            default: lval_atom_print(v); break;
+        }
+
+        /* Close the lists that are done, then move to the next child */
+        while (lwalk.count > base
+                && lwalk.items[lwalk.count-1].i == lwalk.items[lwalk.count-1].v->count) {
+            lwalk.count--;
+            putchar(lwalk.items[lwalk.count].v->type == LVAL_SEXPR ? ')' : '}');
+        }
+        if (lwalk.count == base) { return; }
+
+        /* Don't print a space before the first element */
+        if (lwalk.items[lwalk.count-1].i > 0) { putchar(' '); }
+        v = lwalk.items[lwalk.count-1].v->cell[lwalk.items[lwalk.count-1].i++];
+    }
+}
+
+/* Print an lval followed by a newline */
+void lval_println(lval* v) { lval_print(v); putchar('\n'); }
+
+char* ltype_name(int t) {
+    switch (t) {
+        case LVAL_FUNC: return "Function";
+        case LVAL_NUM: return "Number";
+        case LVAL_FLOAT: return "Float";
+        case LVAL_VEC: return "Vector";
+        case LVAL_STR: return "String";
+        case LVAL_ERR: return "Error";
+        case LVAL_SYM: return "Symbol";
+        case LVAL_SEXPR: return "S-Expression";
+        case LVAL_QEXPR: return "Q-Expression";
+        default: return "Unknown";
+    }
+}
+
+
+/* Lisp Environment */
+
+/* Bindings live in the dense syms/vals arrays in definition order, so a
+   binding keeps its slot for the life of the environment. The index is an
+   open-addressing hash table over the interned symbol pointers which maps
+   each name to its slot plus one, zero marking an empty bucket.
+
+   The frame of a lambda call or a 'let' is an environment too, holding
+   just the names it binds, with no index and a parent to look outward to.
+   A frame is a single allocation with its slots inline after it, and its
+   names are the interned ones, so making and dropping one is a malloc and
+   a free. Frames never grow. They live as long as the call or any lambda
+   defined within it, so environments are reference counted.
+
+   Each global environment gets a fresh version from lenv_version when
+   created and whenever lenv_put changes it, none sharing one until 2^32
+   changes have been made, so a symbol's cached slot is known good while
+   its version matches. Zero is left for symbols never looked up. Frames are
+   never cached in symbols and have no version, which keeps calls from
+   using up the counter. */
+struct lenv {
+    lenv* parent;
+    int refs;
+    int count;
+    char** syms;
+    lval** vals;
+    int size;
+    int* index;
+    unsigned version;
+};
+
+unsigned lenv_version;
+
+unsigned lenv_next_version(void) {
+    if (++lenv_version == 0) { lenv_version = 1; }
+    return lenv_version;
+}
+
+#ifdef LISPC_GC
+/* Every live environment is a root for the collector */
+struct {
+    int count;
+    lenv** envs;
+} lenv_roots;
+#endif
+
+lenv* lenv_init(lenv* e) {
+    e->parent = NULL;
+    e->refs = 1;
+    e->count = 0;
+    e->syms = NULL;
+    e->vals = NULL;
+    e->size = 0;
+    e->index = NULL;
+    e->version = 0;
+#ifdef LISPC_GC
+    lenv_roots.count++;
+    lenv_roots.envs = realloc(lenv_roots.envs, sizeof(lenv*) * lenv_roots.count);
+    lenv_roots.envs[lenv_roots.count-1] = e;
+#endif
+    return e;
+}
+
+lenv* lenv_new(void) {
+    lenv* e = lenv_init(malloc(sizeof(lenv)));
+    e->version = lenv_next_version();
+    return e;
+}
+
+/* A frame of 'count' slots below 'parent', for the caller to fill */
+lenv* lenv_frame(lenv* parent, int count) {
+    lenv* e = lenv_init(malloc(sizeof(lenv)
+        + (sizeof(lval*) + sizeof(char*)) * count));
+    e->parent = parent;
+    parent->refs++;
+    e->count = count;
+    e->vals = (lval**)(e + 1);
+    e->syms = (char**)(e->vals + count);
+    return e;
+}
+
+/* Drop a reference to an environment, freeing it with the last */
+void lenv_del(lenv* e) {
+    if (--e->refs > 0) { return; }
+
+#ifdef LISPC_GC
+    for (int i = 0; i < lenv_roots.count; i++) {
+        if (lenv_roots.envs[i] == e) {
+            lenv_roots.envs[i] = lenv_roots.envs[--lenv_roots.count];
+            break;
+        }
+    }
+#endif
+    for (int i = 0; i < e->count; i++) {
+        lval_del(e->vals[i]);
+    }
+    /* A frame's slots go with it */
+    if (e->parent) {
+        lenv_del(e->parent);
+    } else {
+        free(e->syms);
+        free(e->vals);
+        free(e->index);
+    }
+    free(e);
+}
+
+/* Interned names are unique, so hash the pointer itself */
+unsigned long lenv_hash(char* sym) {
+    return ((uintptr_t)sym >> 3) * 2654435761u;
+}
+
+/* Find the slot bound to an interned name, or -1 if it is unbound */
+int lenv_find(lenv* e, char* sym) {
+    /* Frames are small enough to scan */
+    if (e->size == 0) {
+        for (int i = 0; i < e->count; i++) {
+            if (e->syms[i] == sym) { return i; }
+        }
+        return -1;
+    }
+
+    unsigned long j = lenv_hash(sym) & (e->size-1);
+    while (e->index[j]) {
+        if (e->syms[e->index[j]-1] == sym) {
+            return e->index[j]-1;
+        }
+        j = (j+1) & (e->size-1);
+    }
+    return -1;
+}
+
+void lenv_grow(lenv* e) {
+    free(e->index);
+    e->size = e->size ? e->size * 2 : 64;
+    e->index = calloc(e->size, sizeof(int));
+
+    /* Reinsert every slot into the larger index */
+    for (int i = 0; i < e->count; i++) {
+        unsigned long j = lenv_hash(e->syms[i]) & (e->size-1);
+        while (e->index[j]) { j = (j+1) & (e->size-1); }
+        e->index[j] = i+1;
+    }
+}
+
+lval* lenv_get(lenv* e, lval* k) {
+    /* Look in each frame outward to the global environment */
+    lenv* f = e;
+    for (; f->parent; f = f->parent) {
+        int i = lenv_find(f, k->sym);
+        /* If found, return a copy of the value */
+        if (i >= 0) {
+            return lval_copy(f->vals[i]);
+        }
+    }
+
+    /* Only search the globals if the slot cached in the symbol is stale */
+    if (k->version != f->version) {
+        int i = lenv_find(f, k->sym);
+        /* If no symbol is found, return an error msg */
+        if (i < 0) { return lval_err("Unbound symbol '%s'", k->sym); }
+        k->slot = i;
+        k->version = f->version;
+    }
+    return lval_copy(f->vals[k->slot]);
+}
+
+#ifdef LISPC_GC
+lval* lgc_promote(lval* v);
+#endif
+
+/* Bumped whenever a binding to a pure builtin is replaced, since the VM may
+   have folded calls to it into constants */
+int lenv_epoch;
+
+int lval_pure(lval* f);
+
+void lenv_put(lenv* e, lval* k, lval* v) {
+#ifdef LISPC_GC
+    /* Bound values go straight to the old generation */
+    v = lgc_promote(v);
+#endif
+
+    if (!e->parent) { e->version = lenv_next_version(); }
+
+    /* If variable is found, delete and replace with new value */
+    int i = lenv_find(e, k->sym);
+    if (i >= 0) {
+        if (lval_pure(e->vals[i])) { lenv_epoch++; }
+        lval_del(e->vals[i]);
+        e->vals[i] = lval_copy(v);
+        return;
+    }
+
+    /* If no existing entry found, add new entry to environment */
+    e->count++;
+    e->vals = realloc(e->vals, sizeof(lval*) * e->count);
+    e->syms = realloc(e->syms, sizeof(char*) * e->count);
+
+    /* Copy contents of lval into new location and keep the interned name */
+    e->vals[e->count-1] = lval_copy(v);
+    e->syms[e->count-1] = k->sym;
+
+    /* Keep the index under half full, then record the new slot */
+    if (2 * e->count > e->size) {
+        lenv_grow(e);
+    } else {
+        unsigned long j = lenv_hash(k->sym) & (e->size-1);
+        while (e->index[j]) { j = (j+1) & (e->size-1); }
+        e->index[j] = e->count;
+    }
+}
+
+/* Define a name globally, whichever frame it is defined from */
+void lenv_def(lenv* e, lval* k, lval* v) {
+    while (e->parent) { e = e->parent; }
+    lenv_put(e, k, v);
+}
+
+
+/* Lambdas */
+
+void lchunk_del(lchunk* c);
+
+lfunc* lfunc_new(lenv* e, lval* formals, lval* body) {
+    lfunc* f = malloc(sizeof(lfunc));
+    f->formals = formals;
+    f->body = body;
+    f->env = e;
+    e->refs++;
+    f->code = NULL;
+
+    /* Parameters are the formals without the '&' marking the rest */
+    f->count = 0;
+    f->variadic = 0;
+    f->params = malloc(sizeof(char*) * formals->count);
+    for (int i = 0; i < formals->count; i++) {
+        if (strcmp(formals->cell[i]->sym, "&") == 0) {
+            f->variadic = 1;
+            continue;
+        }
+        f->params[f->count++] = formals->cell[i]->sym;
+    }
+    return f;
+}
+
+/* Construct a lambda closing over 'e', taking the formals and body */
+lval* lval_lambda(lenv* e, lval* formals, lval* body) {
+    lval* v = lval_alloc(LVAL_FUNC);
+    v->func = NULL;
+    v->lambda = lfunc_new(e, formals, body);
+#ifdef LISPC_ARENA
+    larena_final(v);
+#endif
+    return v;
+}
+
+void lvm_disown(lchunk* c);
+
+void lfunc_del(lfunc* f) {
+    lval_del(f->formals);
+    lval_del(f->body);
+    lenv_del(f->env);
+    if (f->code) { lvm_disown(f->code); }
+    free(f->params);
+    free(f);
+}
+
+/* Whether a lambda can be called with 'n' arguments */
+int lfunc_accepts(lfunc* f, int n) {
+    return f->variadic ? n >= f->count-1 : n == f->count;
+}
+
+#ifdef LISPC_GC
+lval* lgc_promote(lval* v);
+#endif
+
+/* A new frame for a call, taking the 'n' arguments, any extras gathered
+   into a list for the parameter after '&' */
+lenv* lfunc_bind(lfunc* f, lval** args, int n) {
+    int fixed = f->variadic ? f->count-1 : f->count;
+
+    lenv* frame = lenv_frame(f->env, f->count);
+    for (int i = 0; i < f->count; i++) {
+        frame->syms[i] = f->params[i];
+    }
+    for (int i = 0; i < fixed; i++) {
+        frame->vals[i] = args[i];
+    }
+    if (f->variadic) {
+        lval* rest = lval_qexpr();
+        lval_reserve(rest, n - fixed);
+        for (int i = fixed; i < n; i++) {
+            rest->cell[rest->count++] = args[i];
+        }
+        frame->vals[fixed] = rest;
+    }
+
+#ifdef LISPC_GC
+    /* Frames, like other environments, only hold old values */
+    for (int i = 0; i < frame->count; i++) {
+        frame->vals[i] = lgc_promote(frame->vals[i]);
+    }
+#endif
+    return frame;
+}
+
+/* Whether 'let' arguments are a list of names, a value for each and a
+   body to evaluate */
+int llet_accepts(lval** args, int n) {
+    if (n < 2 || lval_type(args[0]) != LVAL_QEXPR
+            || lval_type(args[n-1]) != LVAL_QEXPR
+            || args[0]->count != n-2) {
+        return 0;
+    }
+    for (int i = 0; i < args[0]->count; i++) {
+        if (lval_type(args[0]->cell[i]) != LVAL_SYM) { return 0; }
+    }
+    return 1;
+}
+
+/* A new frame below 'e' binding the names to the values, which it takes */
+lenv* llet_bind(lenv* e, lval** args, int n) {
+    lenv* frame = lenv_frame(e, n-2);
+    for (int i = 0; i < n-2; i++) {
+        frame->syms[i] = args[0]->cell[i]->sym;
+#ifdef LISPC_GC
+        frame->vals[i] = lgc_promote(args[i+1]);
+#else
+        frame->vals[i] = args[i+1];
+#endif
+    }
+    return frame;
+}
+
+
+/* Garbage Collection */
+
+#ifdef LISPC_GC
+
+/* The evaluator registers the address of each value it has in flight, so
+   a collection at a safe point sees every live value. */
+struct {
+    int count;
+    int size;
+    lval*** slots;
+} lgc_roots;
+
+/* Running totals, reported on stderr after every collection when the
+   LISPC_GC_STATS environment variable is set */
+struct {
+    int verbose;
+    long minors;
+    long majors;
+    long promoted;
+    long freed;
+    double pause_total;
+    double pause_max;
+} lgc_stats;
+
+/* Promoted lists whose children still have to be evacuated */
+struct {
+    int count;
+    int size;
+    lval** vals;
+} lgc_scan;
+
+void lgc_push(lval** slot) {
+    if (lgc_roots.count == lgc_roots.size) {
+        lgc_roots.size = lgc_roots.size ? lgc_roots.size * 2 : 64;
+        lgc_roots.slots = realloc(lgc_roots.slots, sizeof(lval**) * lgc_roots.size);
+    }
+    lgc_roots.slots[lgc_roots.count++] = slot;
+}
+
+void lgc_pop(void) {
+    lgc_roots.count--;
+}
+
+/* Whole arrays of values in flight, such as the VM operand stack, are
+   registered by the address of their base pointer and length so that they
+   may grow while registered */
+struct {
+    int count;
+    int size;
+    struct {
+        lval*** base;
+        int* count;
+    }* arrays;
+} lgc_arrays;
+
+void lgc_push_array(lval*** base, int* count) {
+    if (lgc_arrays.count == lgc_arrays.size) {
+        lgc_arrays.size = lgc_arrays.size ? lgc_arrays.size * 2 : 64;
+        lgc_arrays.arrays = realloc(lgc_arrays.arrays,
+            sizeof(*lgc_arrays.arrays) * lgc_arrays.size);
+    }
+    lgc_arrays.arrays[lgc_arrays.count].base = base;
+    lgc_arrays.arrays[lgc_arrays.count].count = count;
+    lgc_arrays.count++;
+}
+
+void lgc_pop_array(void) {
+    lgc_arrays.count--;
+}
+
+/* Bytes malloc'd for what value 'v' owns, as counted by lval_owns */
+size_t lgc_owned(lval* v) {
+    switch (v->type) {
+        case LVAL_NUM:
+            if (!(v->flags & LVAL_BIG)) { return 0; }
+            return sizeof(uint32_t) * (v->size < 0 ? -v->size : v->size);
+        case LVAL_ERR: return strlen(v->err) + 1;
+        case LVAL_VEC: return sizeof(int64_t) * v->len;
+        case LVAL_STR: return (v->flags & LVAL_INLINE) ? 0 : v->str_len;
+        case LVAL_SEXPR:
+        case LVAL_QEXPR: return sizeof(lval*) * (v->start + v->cap);
+    }
+    return 0;
+}
+
+/* Copy a young value into the old generation, leaving a forwarding pointer
+   behind. Anything else is returned as it is. */
+lval* lgc_evacuate(lval* v) {
+    if (lval_is_imm(v) || !(v->flags & LGC_YOUNG)) { return v; }
+    if (v->flags & LGC_FORWARD) { return (lval*)v->cell; }
+
+    lval* x = lval_slab_alloc(v->type);
+    *x = *v;
+    x->flags = v->flags & (LVAL_BIG | LVAL_INLINE);
+    v->flags |= LGC_FORWARD;
+    v->cell = (lval**)x;
+    lgc_stats.promoted++;
+
+#ifdef LISPC_ARENA
+    /* Copy out what the value kept in the arena */
+    if (x->type == LVAL_ERR) {
+        char* err = malloc(strlen(x->err) + 1);
+        strcpy(err, x->err);
+        x->err = err;
+    }
+    if (x->type == LVAL_SEXPR || x->type == LVAL_QEXPR) {
+        lval** cell = malloc(sizeof(lval*) * x->count);
+        for (int i = 0; i < x->count; i++) { cell[i] = x->cell[i]; }
+        x->cell = cell;
+        x->start = 0;
+        x->cap = x->count;
+    }
+    if (x->type == LVAL_VEC) {
+        int64_t* ints = malloc(sizeof(int64_t) * (x->len > 0 ? x->len : 1));
+        memcpy(ints, x->ints, sizeof(int64_t) * x->len);
+        x->ints = ints;
+    }
+#endif
+    /* What the value owns now counts towards a major collection */
+    lval_owns(x, lgc_owned(x));
+
+    if (x->type == LVAL_SEXPR || x->type == LVAL_QEXPR || x->type == LVAL_FUNC) {
+        if (lgc_scan.count == lgc_scan.size) {
+            lgc_scan.size = lgc_scan.size ? lgc_scan.size * 2 : 256;
+            lgc_scan.vals = realloc(lgc_scan.vals, sizeof(lval*) * lgc_scan.size);
+        }
+        lgc_scan.vals[lgc_scan.count++] = x;
+    }
+    return x;
+}
+
+void lvm_evacuate(lchunk* c);
+void lvm_mark(lchunk* c);
+
+void lgc_evacuate_cells(lval* v) {
+    /* The children of a lambda include the constants of its code */
+    if (v->type == LVAL_FUNC) {
+        lfunc* f = v->lambda;
+        if (!f) { return; }
+        f->formals = lgc_evacuate(f->formals);
+        f->body = lgc_evacuate(f->body);
+        if (f->code) { lvm_evacuate(f->code); }
+        return;
+    }
+
+    for (int i = 0; i < v->count; i++) {
+        v->cell[i] = lgc_evacuate(v->cell[i]);
+    }
+}
+
+/* Copy everything in the nursery reachable from the roots or from old
+   values into the old generation, then empty the nursery */
+void lgc_minor(void) {
+    /* Environments only ever hold old values, so the roots are the values
+       in flight and the remembered old lists */
+    for (int i = 0; i < lgc_roots.count; i++) {
+        *lgc_roots.slots[i] = lgc_evacuate(*lgc_roots.slots[i]);
+    }
+    for (int i = 0; i < lgc_arrays.count; i++) {
+        lval** vals = *lgc_arrays.arrays[i].base;
+        for (int j = 0; j < *lgc_arrays.arrays[i].count; j++) {
+            vals[j] = lgc_evacuate(vals[j]);
+        }
+    }
+    for (int i = 0; i < lgc_remembered.count; i++) {
+        lgc_remembered.vals[i]->flags &= ~LGC_REMEMBERED;
+        lgc_evacuate_cells(lgc_remembered.vals[i]);
+    }
+    lgc_remembered.count = 0;
+
+    while (lgc_scan.count > 0) {
+        lgc_evacuate_cells(lgc_scan.vals[--lgc_scan.count]);
+    }
+
+#ifdef LISPC_ARENA
+    /* Of the values that died young only lambdas, big Numbers and long
+       Strings own memory elsewhere, so the rest of the arena goes without
+       being looked at */
+    for (int i = 0; i < larena.nfinals; i++) {
+        lval* v = larena.finals[i];
+        if (v->flags & LGC_FORWARD) { continue; }
+        lval_finalize(v);
+    }
+    larena_reset();
+#else
+    /* Release the memory owned by values that died young */
+    for (int i = 0; i < lval_nursery.count; i++) {
+        int used = i == lval_nursery.count-1 ? lval_nursery.used : LISPC_GC_NURSERY;
+        for (int j = 0; j < used; j++) {
+            lval* v = &lval_nursery.chunks[i][j];
+            if (v->refs == 0 || (v->flags & LGC_FORWARD)) { continue; }
+            lval_finalize(v);
+        }
+    }
+#endif
+
+    /* Keep the first chunk for the next round of allocation */
+    for (int i = 1; i < lval_nursery.count; i++) {
+        free(lval_nursery.chunks[i]);
+    }
+    lval_nursery.count = 1;
+    lval_nursery.used = 0;
+    lval_nursery.pending = 0;
+    lval_nursery.bytes = 0;
+    lgc_stats.minors++;
+}
+
+void lgc_mark(lval* v) {
+    int base = lwalk.count;
+    while (1) {
+        if (!lval_is_imm(v) && !(v->flags & LGC_MARK)) {
+            v->flags |= LGC_MARK;
+
+            if (v->type == LVAL_SEXPR || v->type == LVAL_QEXPR) {
+                lwalk_push(v);
+            }
+
+            if (v->type == LVAL_FUNC && v->lambda) {
+                lfunc* f = v->lambda;
+                lgc_mark(f->formals);
+                lgc_mark(f->body);
+                if (f->code) { lvm_mark(f->code); }
+            }
+        }
+
+        while (lwalk.count > base
+                && lwalk.items[lwalk.count-1].i == lwalk.items[lwalk.count-1].v->count) {
+            lwalk.count--;
+        }
+        if (lwalk.count == base) { return; }
+        v = lwalk.items[lwalk.count-1].v->cell[lwalk.items[lwalk.count-1].i++];
+    }
+}
+
+/* Mark and sweep the old generation. The nursery must be empty. */
+long lgc_major(void) {
+    /* Mark everything reachable from the environments and the evaluator */
+    for (int i = 0; i < lenv_roots.count; i++) {
+        lenv* e = lenv_roots.envs[i];
+        for (int j = 0; j < e->count; j++) {
+            lgc_mark(e->vals[j]);
+        }
+    }
+    for (int i = 0; i < lgc_roots.count; i++) {
+        lgc_mark(*lgc_roots.slots[i]);
+    }
+    for (int i = 0; i < lgc_arrays.count; i++) {
+        lval** vals = *lgc_arrays.arrays[i].base;
+        for (int j = 0; j < *lgc_arrays.arrays[i].count; j++) {
+            lgc_mark(vals[j]);
+        }
+    }
+
+    /* Sweep every slab, freeing allocated values left unmarked */
+    long live = 0;
+    size_t live_bytes = 0;
+    for (int i = 0; i < lval_heap.nslabs; i++) {
+        lval* slab = lval_heap.slabs[i];
+        for (int j = 0; j < LVAL_SLAB_SIZE; j++) {
+            lval* v = &slab[j];
+            if (v->refs == 0) { continue; }
+            if (v->flags & LGC_MARK) {
+                v->flags &= ~LGC_MARK;
+                live++;
+                live_bytes += lgc_owned(v);
+            } else {
+                lval_finalize(v);
+                lval_free(v);
+                lgc_stats.freed++;
+            }
+        }
+    }
+
+    /* Let the old generation grow to twice its live size before the next */
+    lval_heap.allocated = 0;
+    lval_heap.threshold = live > LISPC_GC_THRESHOLD ? live : LISPC_GC_THRESHOLD;
+    lval_heap.bytes = 0;
+    lval_heap.byte_threshold = live_bytes > LISPC_GC_BYTES ? live_bytes : LISPC_GC_BYTES;
+    lval_heap.pending = 0;
+    lgc_stats.majors++;
+    return live;
+}
+
+/* Run whichever collections are due. Every live value must be reachable
+   from an environment or the root stack. */
+void lvm_flush(void);
+
+void lgc_collect(void) {
+    clock_t start = clock();
+
+    /* Cached bytecode is keyed on addresses the collector may change */
+    lvm_flush();
+
+    lgc_minor();
+    long live = -1;
+    if (lval_heap.pending) { live = lgc_major(); }
+
+    double pause = (double)(clock() - start) / CLOCKS_PER_SEC;
+    lgc_stats.pause_total += pause;
+    if (pause > lgc_stats.pause_max) { lgc_stats.pause_max = pause; }
+
+    if (lgc_stats.verbose) {
+        fprintf(stderr, "gc: %li minor, %li major, %li promoted, %li freed",
+            lgc_stats.minors, lgc_stats.majors, lgc_stats.promoted, lgc_stats.freed);
+        if (live >= 0) { fprintf(stderr, ", %li live", live); }
+        fprintf(stderr, ", pause %.3f ms (max %.3f ms, total %.3f ms)\n",
+            pause * 1e3, lgc_stats.pause_max * 1e3, lgc_stats.pause_total * 1e3);
+    }
+}
+
+/* Deep copy the young parts of a value into the old generation, so that
+   environments never refer to the nursery */
+lval* lgc_promote(lval* v);
+
+/* Copy a single young value into the old generation. A copied list still
+   refers to the children of the original. */
+lval* lgc_promote_one(lval* v) {
+    lval* x = lval_slab_alloc(v->type);
+    lgc_stats.promoted++;
+    switch (v->type) {
+        case LVAL_FUNC:
+            x->func = v->func;
+            x->lambda = NULL;
+            if (v->lambda) {
+                /* The copy gets its own lambda, compiled again when called */
+                lfunc* f = v->lambda;
+                x->lambda = lfunc_new(f->env,
+                    lgc_promote(f->formals), lgc_promote(f->body));
+            }
+        break;
+        case LVAL_NUM:
+            x->num = v->num;
+            if (v->flags & LVAL_BIG) {
+                int n = v->size < 0 ? -v->size : v->size;
+                x->flags |= LVAL_BIG;
+                x->size = v->size;
+                x->limbs = lval_malloc(x, sizeof(uint32_t) * n);
+                memcpy(x->limbs, v->limbs, sizeof(uint32_t) * n);
+            }
+        break;
+        case LVAL_SYM:
+            x->sym = v->sym;
+            x->slot = v->slot;
+            x->version = v->version;
+        break;
+        case LVAL_ERR:
+            x->err = lval_malloc(x, strlen(v->err) + 1);
+            strcpy(x->err, v->err); break;
+        case LVAL_STR:
+            if (v->flags & LVAL_INLINE) {
+                x->flags |= LVAL_INLINE;
+                x->start = v->start;
+                memcpy(x->chars, v->chars, sizeof(x->chars));
+            } else {
+                v->str->refs++;
+                lval_owns(x, v->str_len);
+                x->str = v->str;
+                x->str_off = v->str_off;
+                x->str_len = v->str_len;
+            }
+        break;
+        case LVAL_VEC:
+            x->len = v->len;
+            x->ints = lval_ints(x, v->len);
+            memcpy(x->ints, v->ints, sizeof(int64_t) * v->len);
+        break;
+        case LVAL_SEXPR:
+        case LVAL_QEXPR:
+            x->start = 0;
+            x->count = v->count;
+            x->cap = v->count;
+            x->cell = lval_cells(x, x->cap);
+            for (int i = 0; i < x->count; i++) { x->cell[i] = v->cell[i]; }
+        break;
+    }
+    return x;
+}
+
+lval* lgc_promote(lval* v) {
+    if (lval_is_imm(v) || !(v->flags & LGC_YOUNG)) { return v; }
+
+    /* Copy lists level by level, replacing their young children */
+    int base = lwalk.count;
+    lval* x = lgc_promote_one(v);
+    if (x->type == LVAL_SEXPR || x->type == LVAL_QEXPR) { lwalk_push(x); }
+
+    while (lwalk.count > base) {
+        lval* y = lwalk.items[--lwalk.count].v;
+        for (int i = 0; i < y->count; i++) {
+            lval* c = y->cell[i];
+            if (lval_is_imm(c) || !(c->flags & LGC_YOUNG)) {
+                /* Old children end up shared with the young original */
+                y->cell[i] = lval_copy(c);
+                continue;
+            }
+            y->cell[i] = lgc_promote_one(c);
+            if (c->type == LVAL_SEXPR || c->type == LVAL_QEXPR) {
+                lwalk_push(y->cell[i]);
+            }
+        }
+    }
+    return x;
+}
+
+#endif
+
+
+/* Reductions */
+
+/* Sums, products, minimums and maximums over many numbers run through
+   kernels on contiguous storage: the integers of a Vector, or arguments
+   unboxed into lsimd_buf first. Each kernel comes in a scalar version, an
+   SSE2 one and an AVX2 one, the best the CPU supports being picked at
+   startup. Arguments that are all fixnums are summed straight from the
+   argument list, decoded on the fly.
+
+   Integer sums are exact. Each element is split into its low and high 32
+   bits, summed apart in 64-bit lanes along with a count of the negative
+   elements, and only the totals are combined in full precision. Float
+   sums and products keep eight running lanes, element i going to lane
+   i % 8, and combine them in a fixed order, so every version gives the
+   same bits. */
+typedef struct {
+    const char* name;
+    void (*sum)(const int64_t* x, int n, uint64_t acc[3]);
+    void (*fixsum)(lval* const* x, int n, uint64_t acc[3]);
+    int64_t (*min)(const int64_t* x, int n);
+    int64_t (*max)(const int64_t* x, int n);
+    double (*fsum)(const double* x, int n);
+    double (*fprod)(const double* x, int n);
+} lsimd_kernels;
+
+/* Calls with fewer arguments than this fold them one at a time instead */
+int lsimd_min_args = 16;
+
+void lsimd_sum_scalar(const int64_t* x, int n, uint64_t acc[3]) {
+    uint64_t lo = 0, hi = 0, neg = 0;
+    for (int i = 0; i < n; i++) {
+        uint64_t u = (uint64_t)x[i];
+        lo += u & 0xFFFFFFFFu;
+        hi += u >> 32;
+        neg += u >> 63;
+    }
+    acc[0] += lo;
+    acc[1] += hi;
+    acc[2] += neg;
+}
+
+/* Fixnums are under 2^48 in size, so a block of this many sums to well
+   within 64 bits before it has to be added to the totals */
+#define LSIMD_BLOCK (1 << 14)
+
+void lsimd_fixsum_scalar(lval* const* x, int n, uint64_t acc[3]) {
+    for (int i = 0; i < n; ) {
+        int end = n - i < LSIMD_BLOCK ? n : i + LSIMD_BLOCK;
+        int64_t s = 0;
+        for (; i < end; i++) { s += LVAL_FIXNUM_GET(x[i]); }
+        lsimd_sum_scalar(&s, 1, acc);
+    }
+}
+
+int64_t lsimd_min_scalar(const int64_t* x, int n) {
+    int64_t m = x[0];
+    for (int i = 1; i < n; i++) { if (x[i] < m) { m = x[i]; } }
+    return m;
+}
+
+int64_t lsimd_max_scalar(const int64_t* x, int n) {
+    int64_t m = x[0];
+    for (int i = 1; i < n; i++) { if (x[i] > m) { m = x[i]; } }
+    return m;
+}
+
+/* Combine eight lanes, then add in what is left over */
+double lsimd_fsum_lanes(double* s, const double* x, int i, int n) {
+    double r = ((s[0] + s[1]) + (s[2] + s[3])) + ((s[4] + s[5]) + (s[6] + s[7]));
+    for (; i < n; i++) { r += x[i]; }
+    return r;
+}
+
+double lsimd_fprod_lanes(double* s, const double* x, int i, int n) {
+    double r = ((s[0] * s[1]) * (s[2] * s[3])) * ((s[4] * s[5]) * (s[6] * s[7]));
+    for (; i < n; i++) { r *= x[i]; }
+    return r;
+}
+
+double lsimd_fsum_scalar(const double* x, int n) {
+    double s[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (int k = 0; k < 8; k++) { s[k] += x[i+k]; }
+    }
+    return lsimd_fsum_lanes(s, x, i, n);
+}
+
+double lsimd_fprod_scalar(const double* x, int n) {
+    double s[8] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (int k = 0; k < 8; k++) { s[k] *= x[i+k]; }
+    }
+    return lsimd_fprod_lanes(s, x, i, n);
+}
+
+lsimd_kernels lsimd_scalar = { "scalar", lsimd_sum_scalar, lsimd_fixsum_scalar,
+    lsimd_min_scalar, lsimd_max_scalar, lsimd_fsum_scalar, lsimd_fprod_scalar };
+
+#ifdef LSIMD_X86
+void lsimd_sum_sse2(const int64_t* x, int n, uint64_t acc[3]) {
+    __m128i lo = _mm_setzero_si128(), hi = lo, neg = lo;
+    __m128i mask = _mm_set1_epi64x(0xFFFFFFFF);
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(x + i));
+        lo = _mm_add_epi64(lo, _mm_and_si128(v, mask));
+        hi = _mm_add_epi64(hi, _mm_srli_epi64(v, 32));
+        neg = _mm_add_epi64(neg, _mm_srli_epi64(v, 63));
+    }
+    uint64_t l[2], h[2], g[2];
+    _mm_storeu_si128((__m128i*)l, lo);
+    _mm_storeu_si128((__m128i*)h, hi);
+    _mm_storeu_si128((__m128i*)g, neg);
+    acc[0] += l[0] + l[1];
+    acc[1] += h[0] + h[1];
+    acc[2] += g[0] + g[1];
+    lsimd_sum_scalar(x + i, n - i, acc);
+}
+
+/* A fixnum's value is its low 49 bits with the sign bit flipped, less the
+   weight of that bit */
+void lsimd_fixsum_sse2(lval* const* x, int n, uint64_t acc[3]) {
+    __m128i mask = _mm_set1_epi64x(0x1FFFFFFFFFFFF);
+    __m128i bias = _mm_set1_epi64x((int64_t)1 << 48);
+    int i = 0;
+    while (i + 2 <= n) {
+        int end = (n & ~1) - i < LSIMD_BLOCK ? (n & ~1) : i + LSIMD_BLOCK;
+        __m128i s = _mm_setzero_si128();
+        for (; i < end; i += 2) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(x + i));
+            v = _mm_xor_si128(_mm_and_si128(v, mask), bias);
+            s = _mm_add_epi64(s, _mm_sub_epi64(v, bias));
+        }
+        int64_t r[2];
+        _mm_storeu_si128((__m128i*)r, s);
+        lsimd_sum_scalar(r, 2, acc);
+    }
+    lsimd_fixsum_scalar(x + i, n - i, acc);
+}
+
+double lsimd_fsum_sse2(const double* x, int n) {
+    __m128d s0 = _mm_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm_add_pd(s0, _mm_loadu_pd(x + i));
+        s1 = _mm_add_pd(s1, _mm_loadu_pd(x + i + 2));
+        s2 = _mm_add_pd(s2, _mm_loadu_pd(x + i + 4));
+        s3 = _mm_add_pd(s3, _mm_loadu_pd(x + i + 6));
+    }
+    double s[8];
+    _mm_storeu_pd(s, s0);
+    _mm_storeu_pd(s + 2, s1);
+    _mm_storeu_pd(s + 4, s2);
+    _mm_storeu_pd(s + 6, s3);
+    return lsimd_fsum_lanes(s, x, i, n);
+}
+
+double lsimd_fprod_sse2(const double* x, int n) {
+    __m128d s0 = _mm_set1_pd(1), s1 = s0, s2 = s0, s3 = s0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm_mul_pd(s0, _mm_loadu_pd(x + i));
+        s1 = _mm_mul_pd(s1, _mm_loadu_pd(x + i + 2));
+        s2 = _mm_mul_pd(s2, _mm_loadu_pd(x + i + 4));
+        s3 = _mm_mul_pd(s3, _mm_loadu_pd(x + i + 6));
+    }
+    double s[8];
+    _mm_storeu_pd(s, s0);
+    _mm_storeu_pd(s + 2, s1);
+    _mm_storeu_pd(s + 4, s2);
+    _mm_storeu_pd(s + 6, s3);
+    return lsimd_fprod_lanes(s, x, i, n);
+}
+
+/* SSE2 has no 64-bit comparison. Built from 32-bit ones it measured
+   slower than the plain loop, so min and max stay scalar. */
+lsimd_kernels lsimd_sse2 = { "sse2", lsimd_sum_sse2, lsimd_fixsum_sse2,
+    lsimd_min_scalar, lsimd_max_scalar, lsimd_fsum_sse2, lsimd_fprod_sse2 };
+
+/* Each AVX2 kernel clears the upper halves of the registers before going
+   back to code built without AVX, which would otherwise pay for the
+   transition on every SSE instruction that follows */
+#define LSIMD_AVX2 __attribute__((target("avx2")))
+
+LSIMD_AVX2 void lsimd_sum_avx2(const int64_t* x, int n, uint64_t acc[3]) {
+    __m256i lo = _mm256_setzero_si256(), hi = lo, neg = lo;
+    __m256i mask = _mm256_set1_epi64x(0xFFFFFFFF);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(x + i));
+        lo = _mm256_add_epi64(lo, _mm256_and_si256(v, mask));
+        hi = _mm256_add_epi64(hi, _mm256_srli_epi64(v, 32));
+        neg = _mm256_add_epi64(neg, _mm256_srli_epi64(v, 63));
+    }
+    uint64_t l[4], h[4], g[4];
+    _mm256_storeu_si256((__m256i*)l, lo);
+    _mm256_storeu_si256((__m256i*)h, hi);
+    _mm256_storeu_si256((__m256i*)g, neg);
+    _mm256_zeroupper();
+    acc[0] += l[0] + l[1] + l[2] + l[3];
+    acc[1] += h[0] + h[1] + h[2] + h[3];
+    acc[2] += g[0] + g[1] + g[2] + g[3];
+    lsimd_sum_scalar(x + i, n - i, acc);
+}
+
+LSIMD_AVX2 void lsimd_fixsum_avx2(lval* const* x, int n, uint64_t acc[3]) {
+    __m256i mask = _mm256_set1_epi64x(0x1FFFFFFFFFFFF);
+    __m256i bias = _mm256_set1_epi64x((int64_t)1 << 48);
+    int i = 0;
+    while (i + 4 <= n) {
+        int end = (n & ~3) - i < LSIMD_BLOCK ? (n & ~3) : i + LSIMD_BLOCK;
+        __m256i s = _mm256_setzero_si256();
+        for (; i < end; i += 4) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(x + i));
+            v = _mm256_xor_si256(_mm256_and_si256(v, mask), bias);
+            s = _mm256_add_epi64(s, _mm256_sub_epi64(v, bias));
+        }
+        int64_t r[4];
+        _mm256_storeu_si256((__m256i*)r, s);
+        for (int k = 0; k < 4; k++) {
+            acc[0] += (uint64_t)r[k] & 0xFFFFFFFFu;
+            acc[1] += (uint64_t)r[k] >> 32;
+            acc[2] += (uint64_t)r[k] >> 63;
+        }
+    }
+    _mm256_zeroupper();
+    lsimd_fixsum_scalar(x + i, n - i, acc);
+}
+
+LSIMD_AVX2 int64_t lsimd_min_avx2(const int64_t* x, int n) {
+    if (n < 4) { return lsimd_min_scalar(x, n); }
+    __m256i m = _mm256_loadu_si256((const __m256i*)x);
+    int i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(x + i));
+        m = _mm256_blendv_epi8(m, v, _mm256_cmpgt_epi64(m, v));
+    }
+    int64_t r[4];
+    _mm256_storeu_si256((__m256i*)r, m);
+    _mm256_zeroupper();
+    int64_t best = lsimd_min_scalar(r, 4);
+    for (; i < n; i++) { if (x[i] < best) { best = x[i]; } }
+    return best;
+}
+
+LSIMD_AVX2 int64_t lsimd_max_avx2(const int64_t* x, int n) {
+    if (n < 4) { return lsimd_max_scalar(x, n); }
+    __m256i m = _mm256_loadu_si256((const __m256i*)x);
+    int i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(x + i));
+        m = _mm256_blendv_epi8(m, v, _mm256_cmpgt_epi64(v, m));
+    }
+    int64_t r[4];
+    _mm256_storeu_si256((__m256i*)r, m);
+    _mm256_zeroupper();
+    int64_t best = lsimd_max_scalar(r, 4);
+    for (; i < n; i++) { if (x[i] > best) { best = x[i]; } }
+    return best;
+}
+
+LSIMD_AVX2 double lsimd_fsum_avx2(const double* x, int n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm256_add_pd(s0, _mm256_loadu_pd(x + i));
+        s1 = _mm256_add_pd(s1, _mm256_loadu_pd(x + i + 4));
+    }
+    double s[8];
+    _mm256_storeu_pd(s, s0);
+    _mm256_storeu_pd(s + 4, s1);
+    _mm256_zeroupper();
+    return lsimd_fsum_lanes(s, x, i, n);
+}
+
+LSIMD_AVX2 double lsimd_fprod_avx2(const double* x, int n) {
+    __m256d s0 = _mm256_set1_pd(1), s1 = s0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm256_mul_pd(s0, _mm256_loadu_pd(x + i));
+        s1 = _mm256_mul_pd(s1, _mm256_loadu_pd(x + i + 4));
+    }
+    double s[8];
+    _mm256_storeu_pd(s, s0);
+    _mm256_storeu_pd(s + 4, s1);
+    _mm256_zeroupper();
+    return lsimd_fprod_lanes(s, x, i, n);
+}
+
+lsimd_kernels lsimd_avx2 = { "avx2", lsimd_sum_avx2, lsimd_fixsum_avx2, lsimd_min_avx2,
+    lsimd_max_avx2, lsimd_fsum_avx2, lsimd_fprod_avx2 };
+#endif
+
+/* The kernels in use, chosen by lsimd_init */
+lsimd_kernels* lsimd = &lsimd_scalar;
+
+/* Pick the best kernels the CPU supports, going no further than 'level':
+   0 for scalar, 1 for SSE2, 2 for AVX2 */
+void lsimd_init(int level) {
+    lsimd = &lsimd_scalar;
+#ifdef LSIMD_X86
+    if (level >= 1) { lsimd = &lsimd_sse2; }
+    if (level >= 2 && __builtin_cpu_supports("avx2")) { lsimd = &lsimd_avx2; }
+#endif
+}
+
+/* An integer sum from the totals kept by the sum kernels. The sum of the
+   elements read as unsigned is hi * 2^32 + lo, and each negative element
+   was read as 2^64 too much. */
+lval* lsimd_sum_result(uint64_t acc[3]) {
+    uint64_t lo = acc[0] + (acc[1] << 32);
+    uint64_t carry = lo < acc[0];
+    int64_t top = (int64_t)((acc[1] >> 32) + carry - acc[2]);
+
+    /* The sum is top * 2^64 + lo */
+    if (top == 0 && lo <= (uint64_t)LONG_MAX) { return lval_num((long)lo); }
+    if (top == -1 && lo > (uint64_t)LONG_MAX) { return lval_num((long)lo); }
+
+    lbig x = lbig_alloc(4);
+    uint64_t mag_lo = lo, mag_hi = (uint64_t)top;
+    x.neg = top < 0;
+    if (x.neg) {
+        /* Negate the two words as one */
+        mag_lo = 0 - lo;
+        mag_hi = ~mag_hi + (lo == 0);
+    }
+    x.d[0] = (uint32_t)mag_lo;
+    x.d[1] = (uint32_t)(mag_lo >> 32);
+    x.d[2] = (uint32_t)mag_hi;
+    x.d[3] = (uint32_t)(mag_hi >> 32);
+    x.n = lmag_trim(x.d, 4);
+    return lval_big(x);
+}
+
+/* Scratch space to unbox arguments into */
+struct {
+    int size;
+    int64_t* ints;
+    double* floats;
+} lsimd_buf;
+
+void lsimd_reserve(int n) {
+    if (n <= lsimd_buf.size) { return; }
+    lsimd_buf.size = n;
+    lsimd_buf.ints = realloc(lsimd_buf.ints, sizeof(int64_t) * n);
+    lsimd_buf.floats = realloc(lsimd_buf.floats, sizeof(double) * n);
+}
+
+/* Unbox the Numbers in 'v', returning 0 if any is big or not a Number */
+int lsimd_unbox_ints(lval* v) {
+    lsimd_reserve(v->count);
+    for (int i = 0; i < v->count; i++) {
+        lval* x = v->cell[i];
+        if (lval_is_fixnum(x)) {
+            lsimd_buf.ints[i] = LVAL_FIXNUM_GET(x);
+        } else if (lval_type(x) == LVAL_NUM && !lbig_is(x)) {
+            lsimd_buf.ints[i] = x->num;
+        } else {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Unbox the Numbers and Floats in 'v' as doubles */
+void lsimd_unbox_floats(lval* v) {
+    lsimd_reserve(v->count);
+    for (int i = 0; i < v->count; i++) {
+        lsimd_buf.floats[i] = lval_float_of(v->cell[i]);
+    }
 }
 
 
 /* Builtins */
 
-#define LASSERT(args, cond, fmt, ...) \
-    if (!(cond)) { \
-        lval* err = lval_err(fmt, ##__VA_ARGS__); \
-        lval_del(args); \
-        return err; \
+#define LASSERT(args, cond, fmt, ...) \
+    if (!(cond)) { \
+        lval* err = lval_err(fmt, ##__VA_ARGS__); \
+        lval_del(args); \
+        return err; \
+    }
+
+#define LASSERT_TYPE(func, args, index, expect) \
+    LASSERT(args, lval_type(args->cell[index]) == expect, \
+        "Function '%s' passed incorrect type for argument %i. Got %s, Expected %s.", \
+        func, index, ltype_name(lval_type(args->cell[index])), ltype_name(expect))
+
+#define LASSERT_NUM(func, args, num) \
+    LASSERT(args, args->count == num, \
+        "Function '%s' passed incorrect number of arguments. Got %i, Expected %i.", \
+        func, args->count, num)
+
+#define LASSERT_NOT_EMPTY(func, args, index) \
+    LASSERT(args, args->cell[index]->count != 0, \
+        "Function '%s' passed {} for argument %i.", func, index);
+
+/* Check that argument 'index' is a Number from 0 to 'max' */
+#define LASSERT_INDEX(func, args, index, max) \
+    LASSERT_TYPE(func, args, index, LVAL_NUM); \
+    LASSERT(args, !lbig_is(args->cell[index]) \
+        && lval_num_get(args->cell[index]) >= 0 \
+        && lval_num_get(args->cell[index]) <= (max), \
+        "Function '%s' passed index out of range for argument %i. Expected 0 to %i.", \
+        func, index, (max))
+
+
+lval* lval_eval(lenv* e, lval* v);
+lval* lval_eval_qexpr(lenv* e, lval* v);
+lval* lval_call(lenv* e, lval* f, lval* a);
+void lvm_prepare(lfunc* f);
+
+/* Builtins are passed the only reference to their argument list, but the
+   arguments themselves may be shared and must be unshared before they are
+   mutated. */
+
+lval* builtin_list(lenv* e, lval* a) {
+    a->type = LVAL_QEXPR;
+    return a;
+}
+
+lval* builtin_head(lenv* e, lval* a) {
+    LASSERT_NUM("head", a, 1);
+    LASSERT_TYPE("head", a, 0, LVAL_QEXPR);
+    LASSERT_NOT_EMPTY("head", a, 0);
+
+    /* Wrap the first element in a new list, letting go of the rest */
+    lval* v = lval_take(a, 0);
+    return lval_add(lval_qexpr(), lval_take(v, 0));
+}
+
+lval* builtin_tail(lenv* e, lval* a) {
+    LASSERT_NUM("tail", a, 1);
+    LASSERT_TYPE("tail", a, 0, LVAL_QEXPR);
+    LASSERT_NOT_EMPTY("tail", a, 0);
+
+    lval* v = lval_take(a, 0);
+#ifndef LISPC_GC
+    /* Rather than copy a shared list, see all but its first cell */
+    if (lval_shared(v)) {
+        lval* x = lval_slice(v, 1, v->count);
+        lval_del(v);
+        return x;
+    }
+#endif
+    v = lval_unshare(v);
+    lval_del(lval_pop(v, 0));
+    return v;
+}
+
+lval* builtin_eval(lenv* e, lval* a) {
+    LASSERT_NUM("eval", a, 1);
+    LASSERT_TYPE("eval", a, 0, LVAL_QEXPR);
+
+    lval* x = lval_take(a, 0);
+    return lval_eval_qexpr(e, x);
+}
+
+lval* builtin_join(lenv* e, lval* a) {
+    LASSERT(a, a->count > 0,
+        "Function 'join' passed no arguments.");
+
+    int total = 0;
+    for (int i = 0; i < a->count; i++) {
+        LASSERT_TYPE("join", a, i, LVAL_QEXPR);
+        total += a->cell[i]->count;
+    }
+
+    /* Size the result once, then consume the arguments in order */
+    lval* x = lval_unshare(a->cell[0]);
+    lval_reserve(x, total);
+    for (int i = 1; i < a->count; i++) {
+        x = lval_join(x, a->cell[i]);
+    }
+
+    /* Every argument now belongs to the result */
+    a->count = 0;
+    lval_del(a);
+    return x;
+}
+
+/* Vectors hold integers unboxed, eight bytes apiece. They are built from
+   and turned back into Q-expressions of Numbers, and are otherwise only
+   read, so slicing copies out the range wanted. */
+
+lval* builtin_vec(lenv* e, lval* a) {
+    LASSERT_NUM("vec", a, 1);
+    LASSERT_TYPE("vec", a, 0, LVAL_QEXPR);
+
+    lval* q = a->cell[0];
+    for (int i = 0; i < q->count; i++) {
+        LASSERT(a, lval_type(q->cell[i]) == LVAL_NUM && !lbig_is(q->cell[i]),
+            "Function 'vec' passed a %s at element %i. Expected a Number of at most 64 bits.",
+            lbig_is(q->cell[i]) ? "big Number" : ltype_name(lval_type(q->cell[i])), i);
+    }
+
+    lval* v = lval_vec(q->count);
+    for (int i = 0; i < q->count; i++) { v->ints[i] = lval_num_get(q->cell[i]); }
+    lval_del(a);
+    return v;
+}
+
+lval* builtin_vec_len(lenv* e, lval* a) {
+    LASSERT_NUM("vec-len", a, 1);
+    LASSERT_TYPE("vec-len", a, 0, LVAL_VEC);
+
+    lval* x = lval_num(a->cell[0]->len);
+    lval_del(a);
+    return x;
+}
+
+lval* builtin_vec_get(lenv* e, lval* a) {
+    LASSERT_NUM("vec-get", a, 2);
+    LASSERT_TYPE("vec-get", a, 0, LVAL_VEC);
+    LASSERT(a, a->cell[0]->len > 0,
+        "Function 'vec-get' passed [] for argument 0.");
+    LASSERT_INDEX("vec-get", a, 1, a->cell[0]->len - 1);
+
+    lval* x = lval_num(a->cell[0]->ints[lval_num_get(a->cell[1])]);
+    lval_del(a);
+    return x;
+}
+
+lval* builtin_vec_slice(lenv* e, lval* a) {
+    LASSERT_NUM("vec-slice", a, 3);
+    LASSERT_TYPE("vec-slice", a, 0, LVAL_VEC);
+    LASSERT_INDEX("vec-slice", a, 1, a->cell[0]->len);
+    LASSERT_INDEX("vec-slice", a, 2, a->cell[0]->len);
+
+    int from = lval_num_get(a->cell[1]);
+    int to = lval_num_get(a->cell[2]);
+    LASSERT(a, from <= to,
+        "Function 'vec-slice' passed a range ending before it starts.");
+
+    lval* v = lval_vec(to - from);
+    memcpy(v->ints, a->cell[0]->ints + from, sizeof(int64_t) * (to - from));
+    lval_del(a);
+    return v;
+}
+
+lval* builtin_vec_list(lenv* e, lval* a) {
+    LASSERT_NUM("vec-list", a, 1);
+    LASSERT_TYPE("vec-list", a, 0, LVAL_VEC);
+
+    lval* v = a->cell[0];
+    lval* x = lval_qexpr();
+    lval_reserve(x, v->len);
+    for (int i = 0; i < v->len; i++) { x->cell[x->count++] = lval_num(v->ints[i]); }
+    lval_del(a);
+    return x;
+}
+
+/* Strings are immutable, so joining them or taking part of one shares the
+   text rather than copying it */
+
+lval* builtin_str_len(lenv* e, lval* a) {
+    LASSERT_NUM("str-len", a, 1);
+    LASSERT_TYPE("str-len", a, 0, LVAL_STR);
+
+    lval* x = lval_num(lval_str_len(a->cell[0]));
+    lval_del(a);
+    return x;
+}
+
+lval* builtin_str_cat(lenv* e, lval* a) {
+    LASSERT(a, a->count > 0,
+        "Function 'str-cat' passed no arguments.");
+    for (int i = 0; i < a->count; i++) {
+        LASSERT_TYPE("str-cat", a, i, LVAL_STR);
+    }
+
+    lval* x = lval_copy(a->cell[0]);
+    for (int i = 1; i < a->count; i++) {
+        x = lval_str_cat(x, a->cell[i]);
+    }
+    lval_del(a);
+    return x;
+}
+
+lval* builtin_str_sub(lenv* e, lval* a) {
+    LASSERT_NUM("str-sub", a, 3);
+    LASSERT_TYPE("str-sub", a, 0, LVAL_STR);
+    int len = lval_str_len(a->cell[0]);
+    LASSERT_INDEX("str-sub", a, 1, len);
+    LASSERT_INDEX("str-sub", a, 2, len);
+
+    int from = lval_num_get(a->cell[1]);
+    int to = lval_num_get(a->cell[2]);
+    LASSERT(a, from <= to,
+        "Function 'str-sub' passed a range ending before it starts.");
+
+    /* A long substring is a view of the same text */
+    lval* v = a->cell[0];
+    lval* x;
+    if (to - from <= LSTR_INLINE) {
+        x = lval_str(lval_str_data(v) + from, to - from);
+    } else {
+        lstr_flatten(v->str);
+        v->str->refs++;
+        x = lval_str_of(v->str, v->str_off + from, to - from);
+    }
+    lval_del(a);
+    return x;
+}
+
+/* Arithmetic operators. Each builtin passes its own, so builtin_op selects
+   a kernel once per call rather than once per operand. */
+enum { LOP_ADD, LOP_SUB, LOP_MUL, LOP_DIV, LOP_MOD, LOP_MIN, LOP_MAX };
+
+char* lop_name[] = { "+", "-", "*", "/", "%", "min", "max" };
+
+/* Arithmetic on longs that reports overflow rather than wrapping */
+#ifdef __GNUC__
+#define lop_add_overflow(x, y, r) __builtin_add_overflow(x, y, r)
+#define lop_sub_overflow(x, y, r) __builtin_sub_overflow(x, y, r)
+#define lop_mul_overflow(x, y, r) __builtin_mul_overflow(x, y, r)
+#else
+int lop_add_overflow(long x, long y, long* r) {
+    if (y > 0 ? x > LONG_MAX - y : x < LONG_MIN - y) { return 1; }
+    *r = x + y;
+    return 0;
+}
+
+int lop_sub_overflow(long x, long y, long* r) {
+    if (y < 0 ? x > LONG_MAX + y : x < LONG_MIN + y) { return 1; }
+    *r = x - y;
+    return 0;
+}
+
+int lop_mul_overflow(long x, long y, long* r) {
+    if (x > 0 ? (y > 0 ? x > LONG_MAX / y : y < LONG_MIN / x)
+              : (y > 0 ? x < LONG_MIN / y : x != 0 && y < LONG_MAX / x)) {
+        return 1;
+    }
+    *r = x * y;
+    return 0;
+}
+#endif
+
+/* Fold the remaining operands into 'x'. The common case of all fixnum
+   operands decodes them straight from the tag without checking for boxes. */
+#define LOP_FOLD(expr) \
+    if (boxed) { \
+        for (; i < n; i++) { long y = lval_num_get(c[i]); expr; } \
+    } else { \
+        for (; i < n; i++) { long y = LVAL_FIXNUM_GET(c[i]); expr; } \
+    }
+
+/* Arithmetic with at least one Float operand, done entirely in doubles */
+lval* builtin_op_float(lval* a, int op) {
+    if (a->count >= lsimd_min_args && (op == LOP_ADD || op == LOP_MUL)) {
+        lsimd_unbox_floats(a);
+        double x = op == LOP_ADD
+            ? lsimd->fsum(lsimd_buf.floats, a->count)
+            : lsimd->fprod(lsimd_buf.floats, a->count);
+        lval_del(a);
+        return lval_float(x);
+    }
+
+    double x = lval_float_of(a->cell[0]);
+    if (op == LOP_SUB && a->count == 1) { x = -x; }
+
+    for (int i = 1; i < a->count; i++) {
+        double y = lval_float_of(a->cell[i]);
+        if ((op == LOP_DIV || op == LOP_MOD) && y == 0) {
+            lval_del(a);
+            return lval_err("Error: Division by zero!");
+        }
+        switch (op) {
+            case LOP_ADD: x += y; break;
+            case LOP_SUB: x -= y; break;
+            case LOP_MUL: x *= y; break;
+            case LOP_DIV: x /= y; break;
+            case LOP_MOD: x = fmod(x, y); break;
+            case LOP_MIN: x = y < x ? y : x; break;
+            case LOP_MAX: x = y > x ? y : x; break;
+        }
+    }
+
+    lval_del(a);
+    return lval_float(x);
+}
+
+lval* builtin_op(lenv* e, lval* a, int op) {
+    LASSERT(a, a->count > 0,
+        "Function '%s' passed no arguments.", lop_name[op]);
+
+    /* Only check types properly if some operand is not a fixnum */
+    int boxed = 0, big = 0, real = 0;
+    for (int i = 0; i < a->count; i++) {
+        if (!lval_is_fixnum(a->cell[i])) { boxed = 1; break; }
+    }
+    if (boxed) {
+        for (int i = 0; i < a->count; i++) {
+            if (lval_type(a->cell[i]) == LVAL_FLOAT) { real = 1; continue; }
+            LASSERT_TYPE(lop_name[op], a, i, LVAL_NUM);
+            if (lbig_is(a->cell[i])) { big = 1; }
+        }
+    }
+
+    /* Any Float among the operands makes the whole operation a Float one */
+    if (real) { return builtin_op_float(a, op); }
+
+    /* Fold over the unboxed values, reading the arguments in place. Should
+       a step overflow, the rest is done in big arithmetic from operand 'i'
+       on, or from the start if 'i' is 0. */
+    lval** c = a->cell;
+    int n = a->count;
+    int i = big ? 0 : 1;
+    long x = big ? 0 : lval_num_get(c[0]), t;
+    if (big) { goto promote; }
+
+    /* Long runs of operands go through the reduction kernels instead */
+    if (n >= lsimd_min_args && (op == LOP_ADD || op == LOP_MIN || op == LOP_MAX)) {
+        lval* r;
+        uint64_t acc[3] = { 0, 0, 0 };
+        if (op == LOP_ADD && !boxed) {
+            lsimd->fixsum(c, n, acc);
+            r = lsimd_sum_result(acc);
+        } else if (op == LOP_ADD) {
+            lsimd_unbox_ints(a);
+            lsimd->sum(lsimd_buf.ints, n, acc);
+            r = lsimd_sum_result(acc);
+        } else {
+            lsimd_unbox_ints(a);
+            r = lval_num(op == LOP_MIN
+                ? lsimd->min(lsimd_buf.ints, n)
+                : lsimd->max(lsimd_buf.ints, n));
+        }
+        lval_del(a);
+        return r;
+    }
+
+    switch (op) {
+        case LOP_ADD:
+            LOP_FOLD(if (lop_add_overflow(x, y, &t)) { goto promote; } x = t);
+        break;
+        case LOP_MUL:
+            LOP_FOLD(if (lop_mul_overflow(x, y, &t)) { goto promote; } x = t);
+        break;
+        case LOP_SUB:
+            /* If no arguments and sub the perform unary negation */
+            if (n == 1) {
+                if (x == LONG_MIN) { i = 0; goto promote; }
+                x = -x;
+            }
+            LOP_FOLD(if (lop_sub_overflow(x, y, &t)) { goto promote; } x = t);
+        break;
+        case LOP_DIV:
+            LOP_FOLD(
+                if (y == 0) { goto div_zero; }
+                if (y == -1 && x == LONG_MIN) { goto promote; }
+                x /= y);
+        break;
+        case LOP_MOD:
+            LOP_FOLD(
+                if (y == 0) { goto div_zero; }
+                x = y == -1 ? 0 : x % y);
+        break;
+        case LOP_MIN: LOP_FOLD(if (y < x) { x = y; }); break;
+        case LOP_MAX: LOP_FOLD(if (y > x) { x = y; }); break;
+    }
+
+    lval_del(a);
+    return lval_num(x);
+
+promote: {
+    lbig r = i == 0 ? lbig_of(c[0]) : lbig_from_long(x);
+    if (i == 0) {
+        if (op == LOP_SUB && n == 1) { r.neg = r.n > 0 && !r.neg; }
+        i = 1;
+    }
+
+    for (; i < n; i++) {
+        lbig y = lbig_of(c[i]), z;
+        if (op == LOP_MIN || op == LOP_MAX) {
+            /* Keep whichever is further in the direction wanted */
+            int cmp = lbig_cmp(y, r);
+            if (op == LOP_MIN ? cmp < 0 : cmp > 0) { z = r; r = y; y = z; }
+            free(y.d);
+            continue;
+        }
+        if ((op == LOP_DIV || op == LOP_MOD) && y.n == 0) {
+            free(r.d);
+            free(y.d);
+            goto div_zero;
+        }
+        switch (op) {
+            case LOP_ADD: z = lbig_add(r, y, 0); break;
+            case LOP_SUB: z = lbig_add(r, y, 1); break;
+            case LOP_MUL: z = lbig_mul(r, y); break;
+            case LOP_DIV: z = lbig_div(r, y, 0); break;
+            default:      z = lbig_div(r, y, 1); break;
+        }
+        free(r.d);
+        free(y.d);
+        r = z;
+    }
+
+    lval_del(a);
+    return lval_big(r);
+}
+
+div_zero:
+    lval_del(a);
+    return lval_err("Error: Division by zero!");
+}
+
+lval* builtin_add(lenv* e, lval* a) {
+    return builtin_op(e, a, LOP_ADD);
+}
+
+lval* builtin_sub(lenv* e, lval* a) {
+    return builtin_op(e, a, LOP_SUB);
+}
+
+lval* builtin_mul(lenv* e, lval* a) {
+    return builtin_op(e, a, LOP_MUL);
+}
+
+lval* builtin_div(lenv* e, lval* a) {
+    return builtin_op(e, a, LOP_DIV);
+}
+
+lval* builtin_mod(lenv* e, lval* a) {
+    return builtin_op(e, a, LOP_MOD);
+}
+
+lval* builtin_min(lenv* e, lval* a) {
+    return builtin_op(e, a, LOP_MIN);
+}
+
+lval* builtin_max(lenv* e, lval* a) {
+    return builtin_op(e, a, LOP_MAX);
+}
+
+/* Reduce a Vector with the kernels directly on its storage */
+lval* builtin_vec_reduce(lval* a, int op) {
+    char* name = op == LOP_ADD ? "vec-sum" : op == LOP_MIN ? "vec-min" : "vec-max";
+    LASSERT_NUM(name, a, 1);
+    LASSERT_TYPE(name, a, 0, LVAL_VEC);
+
+    lval* v = a->cell[0];
+    lval* x;
+    if (op == LOP_ADD) {
+        uint64_t acc[3] = { 0, 0, 0 };
+        lsimd->sum(v->ints, v->len, acc);
+        x = lsimd_sum_result(acc);
+    } else {
+        LASSERT(a, v->len > 0, "Function '%s' passed [] for argument 0.", name);
+        x = lval_num(op == LOP_MIN ? lsimd->min(v->ints, v->len) : lsimd->max(v->ints, v->len));
+    }
+    lval_del(a);
+    return x;
+}
+
+lval* builtin_vec_sum(lenv* e, lval* a) {
+    return builtin_vec_reduce(a, LOP_ADD);
+}
+
+lval* builtin_vec_min(lenv* e, lval* a) {
+    return builtin_vec_reduce(a, LOP_MIN);
+}
+
+lval* builtin_vec_max(lenv* e, lval* a) {
+    return builtin_vec_reduce(a, LOP_MAX);
+}
+
+/* Builtins whose result depends only on their arguments */
+int lval_pure(lval* f) {
+    if (lval_type(f) != LVAL_FUNC || f->lambda) { return 0; }
+    return f->func == builtin_add || f->func == builtin_sub
+        || f->func == builtin_mul || f->func == builtin_div
+        || f->func == builtin_mod || f->func == builtin_min
+        || f->func == builtin_max;
+}
+
+lval* builtin_def(lenv* e, lval* a) {
+
+    LASSERT_TYPE("def", a, 0, LVAL_QEXPR);
+
+    /* First argument is symbol list */
+    lval* syms = a->cell[0];
+
+    /* Ensure all elements of first list are symbols */
+    for (int i = 0; i < syms->count; i++) {
+        LASSERT(a, (lval_type(syms->cell[i]) == LVAL_SYM),
+            "Function 'def' cannot define non-symbol. "
+            "Got %s, Expected %s.",
+            ltype_name(lval_type(syms->cell[i])), ltype_name(LVAL_SYM));
+    }
+
+    /* Check correct number of symbols and values */
+    LASSERT(a, (syms->count == a->count-1),
+        "Function 'def' passed too many arguments for symbols. "
+        "Got %i, Expected %i.",
+        syms->count, a->count-1);
+
+    /* Assign copies of values to symbols */
+    for (int i = 0; i < syms->count; i++) {
+        lenv_def(e, syms->cell[i], a->cell[i+1]);
+    }
+
+    lval_del(a);
+    return lval_sexpr();
+}
+
+lval* builtin_lambda(lenv* e, lval* a) {
+    LASSERT_NUM("\\", a, 2);
+    LASSERT_TYPE("\\", a, 0, LVAL_QEXPR);
+    LASSERT_TYPE("\\", a, 1, LVAL_QEXPR);
+
+    /* Ensure the formals are symbols, with exactly one after any '&' */
+    lval* syms = a->cell[0];
+    for (int i = 0; i < syms->count; i++) {
+        LASSERT(a, (lval_type(syms->cell[i]) == LVAL_SYM),
+            "Cannot define non-symbol. Got %s, Expected %s.",
+            ltype_name(lval_type(syms->cell[i])), ltype_name(LVAL_SYM));
+        LASSERT(a, strcmp(syms->cell[i]->sym, "&") != 0 || i == syms->count-2,
+            "Function format invalid. Symbol '&' not followed by single symbol.");
+    }
+
+    lval* formals = lval_pop(a, 0);
+    lval* body = lval_pop(a, 0);
+    lval_del(a);
+
+    /* Resolve the body against its frames now rather than on each call */
+    lval* f = lval_lambda(e, formals, body);
+    lvm_prepare(f->lambda);
+    return f;
+}
+
+/* let {x y} 1 2 {body} evaluates the body with x and y bound to 1 and 2 in
+   a new scope, which is gone again afterwards unless a lambda keeps it */
+lval* builtin_let(lenv* e, lval* a) {
+    LASSERT(a, a->count >= 2,
+        "Function 'let' passed too few arguments. Got %i, Expected 2 or more.",
+        a->count);
+    LASSERT_TYPE("let", a, 0, LVAL_QEXPR);
+    LASSERT_TYPE("let", a, a->count-1, LVAL_QEXPR);
+
+    lval* syms = a->cell[0];
+    for (int i = 0; i < syms->count; i++) {
+        LASSERT(a, (lval_type(syms->cell[i]) == LVAL_SYM),
+            "Function 'let' cannot define non-symbol. "
+            "Got %s, Expected %s.",
+            ltype_name(lval_type(syms->cell[i])), ltype_name(LVAL_SYM));
+    }
+    LASSERT(a, (syms->count == a->count-2),
+        "Function 'let' passed incorrect number of values for symbols. "
+        "Got %i, Expected %i.",
+        a->count-2, syms->count);
+
+    lenv* frame = llet_bind(e, a->cell, a->count);
+    lval* body = a->cell[a->count-1];
+    a->count = 1;
+    lval_del(a);
+
+    lval* x = lval_eval_qexpr(frame, body);
+    lenv_del(frame);
+    return x;
+}
+
+void lenv_add_builtin(lenv* e, char* name, lbuiltin func) {
+    lval* k = lval_sym(name);
+    lval* v = lval_func(func);
+    lenv_put(e, k, v);
+    lval_del(k);
+    lval_del(v);
+}
+
+void lenv_add_builtins(lenv* e) {
+    /* Variable functions */
+    lenv_add_builtin(e, "def", builtin_def);
+    lenv_add_builtin(e, "\\", builtin_lambda);
+    lenv_add_builtin(e, "let", builtin_let);
+    /* List functions */
+    lenv_add_builtin(e, "list", builtin_list);
+    lenv_add_builtin(e, "head", builtin_head);
+    lenv_add_builtin(e, "tail", builtin_tail);
+    lenv_add_builtin(e, "eval", builtin_eval);
+    lenv_add_builtin(e, "join", builtin_join);
+    /* Vector functions */
+    lenv_add_builtin(e, "vec", builtin_vec);
+    lenv_add_builtin(e, "vec-len", builtin_vec_len);
+    lenv_add_builtin(e, "vec-get", builtin_vec_get);
+    lenv_add_builtin(e, "vec-slice", builtin_vec_slice);
+    lenv_add_builtin(e, "vec-list", builtin_vec_list);
+    lenv_add_builtin(e, "vec-sum", builtin_vec_sum);
+    lenv_add_builtin(e, "vec-min", builtin_vec_min);
+    lenv_add_builtin(e, "vec-max", builtin_vec_max);
+    /* String functions */
+    lenv_add_builtin(e, "str-len", builtin_str_len);
+    lenv_add_builtin(e, "str-cat", builtin_str_cat);
+    lenv_add_builtin(e, "str-sub", builtin_str_sub);
+    /* Mathematical functions */
+    lenv_add_builtin(e, "+", builtin_add);
+    lenv_add_builtin(e, "-", builtin_sub);
+    lenv_add_builtin(e, "*", builtin_mul);
+    lenv_add_builtin(e, "/", builtin_div);
+    lenv_add_builtin(e, "%", builtin_mod);
+    lenv_add_builtin(e, "min", builtin_min);
+    lenv_add_builtin(e, "max", builtin_max);
+}
+
+
+/* Evaluation */
+
+/* The tree walking evaluator, used when the VM is disabled. It keeps its
+   own stack of the S-expressions whose children are being evaluated, with
+   the environment of each and the frame of any lambda it entered by a tail
+   call, instead of recursing on nesting depth. */
+struct {
+    int depth;
+    int count;
+    int size;
+    lval** exprs;
+    int* next;
+    lenv** envs;
+    lenv** frames;
+} ltree;
+
+void ltree_push(lval* v, lenv* e, lenv* frame) {
+    if (ltree.count == ltree.size) {
+        ltree.size = ltree.size ? ltree.size * 2 : 64;
+        ltree.exprs = realloc(ltree.exprs, sizeof(lval*) * ltree.size);
+        ltree.next = realloc(ltree.next, sizeof(int) * ltree.size);
+        ltree.envs = realloc(ltree.envs, sizeof(lenv*) * ltree.size);
+        ltree.frames = realloc(ltree.frames, sizeof(lenv*) * ltree.size);
+    }
+    ltree.exprs[ltree.count] = v;
+    ltree.next[ltree.count] = 0;
+    ltree.envs[ltree.count] = e;
+    ltree.frames[ltree.count] = frame;
+    ltree.count++;
+}
+
+/* Apply an S-expression whose children have all been evaluated. A call to
+   a lambda, eval or let is not made but continued in place: NULL is
+   returned and '*v' is left holding the expression to evaluate next, in
+   '*e'. The frame of a lambda or let is kept in '*frame' until the
+   evaluation is done. */
+lval* lval_apply_tree(lenv** e, lval** v, lenv** frame) {
+    lval* a = *v;
+
+    /* Error checking */
+    for (int i = 0; i < a->count; i++) {
+        if (lval_type(a->cell[i]) == LVAL_ERR) {
+            return lval_take(a, i);
+        }
+    }
+
+    /* Empty expression */
+    if (a->count == 0) {
+        return a;
+    }
+
+    /* Single expression */
+    if (a->count == 1) {
+        return lval_take(a, 0);
+    }
+
+    /* Ensure first element is a function */
+    lval* f = lval_pop(a, 0);
+    if (lval_type(f) != LVAL_FUNC) {
+        lval_del(a);
+        lval_del(f);
+        return lval_err("Error: First element is not a function!");
+    }
+
+    /* Carry on with the body of the lambda or the argument to eval,
+       leaving lval_call to report any bad arguments */
+    lfunc* l = f->lambda;
+    if (l && lfunc_accepts(l, a->count)) {
+        lenv* next = lfunc_bind(l, a->cell, a->count);
+        a->count = 0;
+        lval_del(a);
+        if (*frame) { lenv_del(*frame); }
+        *e = *frame = next;
+        a = lval_copy(l->body);
+    } else if (!l && f->func == builtin_eval && a->count == 1
+            && lval_type(a->cell[0]) == LVAL_QEXPR) {
+        a = lval_take(a, 0);
+    } else if (!l && f->func == builtin_let && llet_accepts(a->cell, a->count)) {
+        lenv* next = llet_bind(*e, a->cell, a->count);
+        lval* body = a->cell[a->count-1];
+        a->count = 1;
+        lval_del(a);
+        if (*frame) { lenv_del(*frame); }
+        *e = *frame = next;
+        a = body;
+    } else {
+        /* Call function with operator */
+        lval* result = lval_call(*e, f, a);
+        lval_del(f);
+        return result;
+    }
+    lval_del(f);
+
+    a = lval_unshare(a);
+    a->type = LVAL_SEXPR;
+    *v = a;
+    return NULL;
+}
+
+lval* lval_eval_tree(lenv* e, lval* v) {
+    int base = ltree.count;
+#ifdef LISPC_GC
+    /* The outermost evaluation roots the whole stack */
+    if (ltree.depth == 0) { lgc_push_array(&ltree.exprs, &ltree.count); }
+#endif
+    ltree.depth++;
+
+    lenv* frame = NULL;
+    lval* x;
+
+    while (1) {
+#ifdef LISPC_GC
+        /* Safe point: everything live is rooted in an environment or on the
+           root stack, so collect here if the threshold has been passed */
+        if (lgc_pending()) {
+            lgc_push(&v);
+            lgc_collect();
+            lgc_pop();
+        }
+#endif
+
+        /* Immediate values evaluate to themselves */
+        if (lval_is_imm(v)) {
+            x = v;
+        } else if (v->type == LVAL_SYM) {
+            x = lenv_get(e, v);
+            lval_del(v);
+        } else if (v->type == LVAL_SEXPR) {
+            /* Children are replaced by their values, so take a private copy */
+            ltree_push(lval_unshare(v), e, frame);
+            frame = NULL;
+            x = NULL;
+        } else {
+            x = v;
+        }
+
+        /* Hand each value to the expression waiting for it, applying those
+           with every child evaluated, until something else needs evaluating */
+        while (1) {
+            if (x) {
+                if (frame) { lenv_del(frame); frame = NULL; }
+                if (ltree.count == base) { goto done; }
+
+                int t = ltree.count-1;
+#ifdef LISPC_GC
+                lgc_barrier(ltree.exprs[t], x);
+#endif
+                ltree.exprs[t]->cell[ltree.next[t]++] = x;
+            }
+
+            int t = ltree.count-1;
+            lval* list = ltree.exprs[t];
+            e = ltree.envs[t];
+            if (ltree.next[t] < list->count) {
+                v = list->cell[ltree.next[t]];
+                break;
+            }
+
+            ltree.count--;
+            v = list;
+            frame = ltree.frames[t];
+            x = lval_apply_tree(&e, &v, &frame);
+            if (!x) { break; }
+        }
+    }
+
+done:
+    ltree.depth--;
+#ifdef LISPC_GC
+    if (ltree.depth == 0) { lgc_pop_array(); }
+#endif
+    return x;
+}
+
+
+/* Bytecode VM */
+
+/* By default lval_eval compiles an expression into a chunk of bytecode and
+   runs it on a stack machine. Each S-expression becomes code pushing its
+   children followed by a CALL of that many values. Symbols bound at compile
+   time are read straight from their environment slot, and parameters of
+   the enclosing lambdas from their frame by (depth, index). Running with
+   --no-vm falls back to the tree walker.
+
+   Calls to pure builtins on constant numbers are folded into their value
+   as they are compiled, unless --no-fold is given. The folded value is only
+   used while no pure builtin has been rebound since; otherwise the original
+   expression is evaluated in its place.
+
+   Shared lists are immutable, so the chunk compiled for one is cached and
+   reused each time it is evaluated, until the list is freed or unshared
+   for mutation. */
+enum { LVM_CONST, LVM_GLOBAL, LVM_LOCAL, LVM_NAME, LVM_FOLD, LVM_CALL,
+       LVM_TAIL, LVM_RET };
+
+/* A LOCAL operand packs the frame depth above the frame index */
+#define LVM_LOCAL_BITS 16
+
+struct lchunk {
+    int count;
+    int size;
+    int* code;
+    int nconsts;
+    int sconsts;
+    lval** consts;
+    /* Decoded copy of the code for threaded dispatch, made on first run */
+    void** thread;
+    /* Stack height while compiling, and the most a run can need */
+    int height;
+    int max;
+    /* Cache entry for the source list in an environment */
+    lval* src;
+    lenv* env;
+    int running;
+    int cached;
+    lchunk* next;
+    /* Set while the chunk is the code of a lambda */
+    int owned;
+    /* Value of lenv_epoch when compiled */
+    int epoch;
+};
+
+/* Labels as values are a GCC extension, also supported by Clang. Other
+   compilers, or builds with -DLISPC_NO_THREADED, only have the switch. */
+#if defined(__GNUC__) && !defined(LISPC_NO_THREADED)
+#define LVM_THREADED
+#endif
+
+#ifdef LISPC_GC
+/* Values in flight are all on the stack before a call, so collect there */
+#define LVM_SAFEPOINT() \
+    if (lgc_pending()) { lgc_collect(); }
+#else
+#define LVM_SAFEPOINT()
+#endif
+
+/* The operand stack is shared by nested runs, each working above the last */
+struct {
+    int enabled;
+    int threaded;
+    int fold;
+    int depth;
+    int sp;
+    int size;
+    lval** stack;
+} lvm = { 1, 1, 1, 0, 0, 0, NULL };
+
+/* Chunks for shared lists, chained in buckets by source pointer */
+struct {
+    size_t count;
+    size_t size;
+    lchunk** buckets;
+} lvm_cache;
+
+void lchunk_del(lchunk* c) {
+    for (int i = 0; i < c->nconsts; i++) {
+        lval_del(c->consts[i]);
+    }
+    free(c->consts);
+    free(c->code);
+    free(c->thread);
+    free(c);
+}
+
+void lchunk_emit(lchunk* c, int op, int arg) {
+    if (c->count + 2 > c->size) {
+        c->size = c->size ? c->size * 2 : 16;
+        c->code = realloc(c->code, sizeof(int) * c->size);
+    }
+    c->code[c->count++] = op;
+    c->code[c->count++] = arg;
+
+    switch (op) {
+        case LVM_CALL:
+        case LVM_TAIL: c->height -= arg - 1; break;
+        case LVM_RET: c->height--; break;
+        default: c->height++; break;
+    }
+    if (c->height > c->max) { c->max = c->height; }
+}
+
+int lchunk_const(lchunk* c, lval* v) {
+    if (c->nconsts == c->sconsts) {
+        c->sconsts = c->sconsts ? c->sconsts * 2 : 8;
+        c->consts = realloc(c->consts, sizeof(lval*) * c->sconsts);
+    }
+    c->consts[c->nconsts++] = lval_copy(v);
+    return c->nconsts-1;
+}
+
+void lvm_compile_sym(lenv* e, lchunk* c, lval* v) {
+    /* Search the frames innermost first, then the globals */
+    lenv* f = e;
+    for (int depth = 0; f->parent; f = f->parent, depth++) {
+        int i = lenv_find(f, v->sym);
+        if (i < 0) { continue; }
+        if (i >> LVM_LOCAL_BITS || depth >> (30 - LVM_LOCAL_BITS)) { break; }
+        lchunk_emit(c, LVM_LOCAL, depth << LVM_LOCAL_BITS | i);
+        return;
+    }
+
+    int slot = f->parent ? -1 : lenv_find(f, v->sym);
+    if (slot >= 0) {
+        lchunk_emit(c, LVM_GLOBAL, slot);
+    } else {
+        /* Unbound for now, so look it up by name when run */
+        lchunk_emit(c, LVM_NAME, lchunk_const(c, v));
+    }
+}
+
+lenv* lvm_global(lenv* e);
+
+/* Replace the code from 'at' for S-expression 'v' with its value, if it is
+   a call to a pure builtin on constant numbers. The expression is kept as
+   a constant after the value, to be evaluated if the fold goes stale. */
+int lvm_fold(lenv* e, lchunk* c, lval* v, int at) {
+    /* Each child must have compiled to a single instruction */
+    if (!lvm.fold || v->count < 2 || c->count - at != 2 * v->count) { return 0; }
+    int* code = c->code + at;
+
+    /* The function as bound now */
+    lval* f;
+    switch (code[0]) {
+        case LVM_GLOBAL: f = lvm_global(e)->vals[code[1]]; break;
+        case LVM_CONST: f = c->consts[code[1]]; break;
+        default: return 0;
+    }
+    if (!lval_pure(f)) { return 0; }
+
+    lval* a = lval_sexpr();
+    lval_reserve(a, v->count-1);
+    for (int i = 1; i < v->count; i++) {
+        int op = code[2*i];
+        if ((op != LVM_CONST && op != LVM_FOLD)
+                || !lval_is_number(c->consts[code[2*i+1]])) {
+            lval_del(a);
+            return 0;
+        }
+        a->cell[a->count++] = lval_copy(c->consts[code[2*i+1]]);
+    }
+
+    /* Errors such as division by zero are left to happen when run */
+    lval* r = f->func(e, a);
+    if (!lval_is_number(r)) {
+        lval_del(r);
+        return 0;
+    }
+#ifdef LISPC_GC
+    /* The code of an old lambda is not scanned for young constants */
+    r = lgc_promote(r);
+#endif
+
+    c->count = at;
+    c->height -= v->count;
+    int k = lchunk_const(c, r);
+    lchunk_const(c, v);
+    lchunk_emit(c, LVM_FOLD, k);
+    lval_del(r);
+    return 1;
+}
+
+void lvm_compile(lenv* e, lchunk* c, lval* v) {
+    int base = lwalk.count;
+    while (1) {
+        switch (lval_type(v)) {
+            case LVAL_SYM: lvm_compile_sym(e, c, v); break;
+            /* Children first, the call once they are all compiled */
+            case LVAL_SEXPR:
+                lwalk_push(v);
+                lwalk.items[lwalk.count-1].mark = c->count;
+            break;
+            /* Everything else evaluates to itself */
+            default: lchunk_emit(c, LVM_CONST, lchunk_const(c, v)); break;
+        }
+
+        while (lwalk.count > base
+                && lwalk.items[lwalk.count-1].i == lwalk.items[lwalk.count-1].v->count) {
+            lwalk.count--;
+            lval* list = lwalk.items[lwalk.count].v;
+            if (!lvm_fold(e, c, list, lwalk.items[lwalk.count].mark)) {
+                lchunk_emit(c, LVM_CALL, list->count);
+            }
+        }
+        if (lwalk.count == base) { return; }
+        v = lwalk.items[lwalk.count-1].v->cell[lwalk.items[lwalk.count-1].i++];
+    }
+}
+
+/* Compile the children of a list as one S-expression, whatever its type */
+lchunk* lvm_compile_list(lenv* e, lval* v) {
+    lchunk* c = calloc(1, sizeof(lchunk));
+    c->epoch = lenv_epoch;
+    for (int i = 0; i < v->count; i++) {
+        lvm_compile(e, c, v->cell[i]);
+    }
+    lchunk_emit(c, LVM_TAIL, v->count);
+    lchunk_emit(c, LVM_RET, 0);
+    return c;
+}
+
+unsigned long lvm_hash(lval* v) {
+    return ((uintptr_t)v >> 3) * 2654435761u;
+}
+
+/* A chunk is freed once it is neither cached, owned by a lambda nor
+   being run */
+void lvm_release(lchunk* c) {
+    if (!c->running && !c->cached && !c->owned) { lchunk_del(c); }
+}
+
+/* Take a chunk out of the cache */
+void lvm_evict(lchunk* c) {
+    c->cached = 0;
+    lvm_cache.count--;
+    lvm_release(c);
+}
+
+/* Called when the lambda owning a chunk is freed */
+void lvm_disown(lchunk* c) {
+    c->owned = 0;
+    lvm_release(c);
+}
+
+/* Drop any chunks cached for a list */
+void lvm_forget(lval* v) {
+    v->flags &= ~LVAL_COMPILED;
+    if (lvm_cache.size == 0) { return; }
+
+    lchunk** p = &lvm_cache.buckets[lvm_hash(v) & (lvm_cache.size-1)];
+    while (*p) {
+        lchunk* c = *p;
+        if (c->src == v) {
+            *p = c->next;
+            lvm_evict(c);
+        } else {
+            p = &c->next;
+        }
+    }
+}
+
+/* Drop every cached chunk */
+void lvm_flush(void) {
+    for (size_t i = 0; i < lvm_cache.size; i++) {
+        while (lvm_cache.buckets[i]) {
+            lchunk* c = lvm_cache.buckets[i];
+            lvm_cache.buckets[i] = c->next;
+            lvm_evict(c);
+        }
+    }
+}
+
+/* Find or compile the chunk for a shared list in an environment */
+lchunk* lvm_lookup(lenv* e, lval* v) {
+    if (lvm_cache.size > 0) {
+        lchunk** p = &lvm_cache.buckets[lvm_hash(v) & (lvm_cache.size-1)];
+        for (; *p; p = &(*p)->next) {
+            lchunk* c = *p;
+            if (c->src != v || c->env != e) { continue; }
+            if (c->epoch == lenv_epoch) { return c; }
+
+            /* Compile again rather than run stale folds */
+            *p = c->next;
+            lvm_evict(c);
+            break;
+        }
+    }
+
+    /* Keep the chains short by doubling the buckets */
+    if (lvm_cache.count >= lvm_cache.size) {
+        size_t size = lvm_cache.size ? lvm_cache.size * 2 : 256;
+        lchunk** buckets = calloc(size, sizeof(lchunk*));
+        for (size_t i = 0; i < lvm_cache.size; i++) {
+            while (lvm_cache.buckets[i]) {
+                lchunk* c = lvm_cache.buckets[i];
+                lvm_cache.buckets[i] = c->next;
+                c->next = buckets[lvm_hash(c->src) & (size-1)];
+                buckets[lvm_hash(c->src) & (size-1)] = c;
+            }
+        }
+        free(lvm_cache.buckets);
+        lvm_cache.buckets = buckets;
+        lvm_cache.size = size;
+    }
+
+    lchunk* c = lvm_compile_list(e, v);
+    c->src = v;
+    c->env = e;
+    c->cached = 1;
+    c->next = lvm_cache.buckets[lvm_hash(v) & (lvm_cache.size-1)];
+    lvm_cache.buckets[lvm_hash(v) & (lvm_cache.size-1)] = c;
+    lvm_cache.count++;
+    v->flags |= LVAL_COMPILED;
+    return c;
+}
+
+/* Make room for a chunk's values so pushes need no checks */
+void lvm_reserve(int n) {
+    if (lvm.sp + n <= lvm.size) { return; }
+    while (lvm.sp + n > lvm.size) {
+        lvm.size = lvm.size ? lvm.size * 2 : 256;
+    }
+    lvm.stack = realloc(lvm.stack, sizeof(lval*) * lvm.size);
+}
+
+/* Apply the top 'n' values on the stack as an S-expression, following the
+   same rules as lval_eval_sexpr */
+lval* lvm_call(lenv* e, int n) {
+    lval** vals = &lvm.stack[lvm.sp - n];
+
+    /* Error checking */
+    for (int i = 0; i < n; i++) {
+        if (lval_type(vals[i]) == LVAL_ERR) {
+            lval* err = vals[i];
+            for (int j = 0; j < n; j++) {
+                if (j != i) { lval_del(vals[j]); }
+            }
+            lvm.sp -= n;
+            return err;
+        }
+    }
+
+    /* Empty expression */
+    if (n == 0) {
+        return lval_sexpr();
+    }
+
+    /* Single expression */
+    if (n == 1) {
+        lvm.sp--;
+        return vals[0];
     }
 
-#define LASSERT_TYPE(func, args, index, expect) \
-    LASSERT(args, args->cell[index]->type == expect, \
-        "Function '%s' passed incorrect type for argument %i. Got %s, Expected %s.", \
-        func, index, ltype_name(args->cell[index]->type), ltype_name(expect))
+    /* Ensure first element is a function */
+    lval* f = vals[0];
+    if (lval_type(f) != LVAL_FUNC) {
+        for (int i = 0; i < n; i++) { lval_del(vals[i]); }
+        lvm.sp -= n;
+        return lval_err("Error: First element is not a function!");
+    }
 
-#define LASSERT_NUM(func, args, num) \
-    LASSERT(args, args->count == num, \
-        "Function '%s' passed incorrect number of arguments. Got %i, Expected %i.", \
-        func, args->count, num)
+    /* Move the arguments off the stack into a list for the builtin */
+    lval* a = lval_sexpr();
+    lval_reserve(a, n-1);
+    memcpy(a->cell, vals + 1, sizeof(lval*) * (n-1));
+    a->count = n-1;
+    lvm.sp -= n;
 
-#define LASSERT_NOT_EMPTY(func, args, index) \
-    LASSERT(args, args->cell[index]->count != 0, \
-        "Function '%s' passed {} for argument %i.", func, index);
+    lval* result = lval_call(e, f, a);
+    lval_del(f);
+    return result;
+}
 
+/* The chunk to evaluate a list with, cached if the list is shared. Frames
+   come and go, so only code run globally is worth caching. */
+lchunk* lvm_chunk(lenv* e, lval* v) {
+    return v->refs > 1 && !e->parent ? lvm_lookup(e, v) : lvm_compile_list(e, v);
+}
 
-lval* lval_eval(lenv* e, lval* v);
+/* Start and finish running a chunk */
+void lvm_enter(lchunk* c) {
+    c->running++;
+    lvm_reserve(c->max);
+#ifdef LISPC_GC
+    lgc_push_array(&c->consts, &c->nconsts);
+#endif
+}
 
-lval* builtin_list(lenv* e, lval* a) {
-    a->type = LVAL_QEXPR;
-    return a;
+void lvm_leave(lchunk* c) {
+#ifdef LISPC_GC
+    lgc_pop_array();
+#endif
+    c->running--;
+    lvm_release(c);
 }
 
-lval* builtin_head(lenv* e, lval* a) {
-    LASSERT_NUM("head", a, 1);
-    LASSERT_TYPE("head", a, 0, LVAL_QEXPR);
-    LASSERT_NOT_EMPTY("head", a, 0);
+/* Make the call in tail position at the end of a chunk. A call to a lambda,
+   eval or let carries on in the current run rather than nesting another:
+   '*c' is replaced by the code to continue with, and the frame of a lambda
+   or let is held in '*frame' until the run moves on. Returns 0 for any
+   other call, which is then made as usual. */
+int lvm_tail(lchunk** c, lenv** e, lenv** frame, int n) {
+    lval** vals = &lvm.stack[lvm.sp - n];
+    if (n < 2 || lval_type(vals[0]) != LVAL_FUNC) { return 0; }
+    for (int i = 1; i < n; i++) {
+        if (lval_type(vals[i]) == LVAL_ERR) { return 0; }
+    }
 
-    lval* v = lval_take(a, 0);
-    while (v->count > 1) {
-        lval_del(lval_pop(v, 1));
+    lval* f = vals[0];
+    lenv* env = *e;
+    lchunk* next;
+    /* Arguments left to let go once switched, the rest having been bound */
+    lval* done[2] = { NULL, NULL };
+    if (f->lambda && lfunc_accepts(f->lambda, n-1)) {
+        lvm_prepare(f->lambda);
+        next = f->lambda->code;
+        env = lfunc_bind(f->lambda, vals + 1, n-1);
+    } else if (f->func == builtin_eval && n == 2
+            && lval_type(vals[1]) == LVAL_QEXPR) {
+        next = lvm_chunk(env, vals[1]);
+        done[0] = vals[1];
+    } else if (f->func == builtin_let && llet_accepts(vals + 1, n-1)) {
+        env = llet_bind(env, vals + 1, n-1);
+        next = lvm_chunk(env, vals[n-1]);
+        done[0] = vals[1];
+        done[1] = vals[n-1];
+    } else {
+        return 0;
     }
-    return v;
-}
 
-lval* builtin_tail(lenv* e, lval* a) {
-    LASSERT_NUM("tail", a, 1);
-    LASSERT_TYPE("tail", a, 0, LVAL_QEXPR);
-    LASSERT_NOT_EMPTY("tail", a, 0);
+    /* Switch chunks before the Q-expression evaluated is let go, which may
+       evict the code cached for it */
+    lvm_leave(*c);
+    lvm_enter(next);
+    for (int i = 0; i < 2; i++) {
+        if (done[i]) { lval_del(done[i]); }
+    }
+    lvm.sp -= n;
 
-    lval* v = lval_take(a, 0);
-    lval_del(lval_pop(v, 0));
-    return v;
+    if (env != *e) {
+        if (*frame) { lenv_del(*frame); }
+        *frame = env;
+        *e = env;
+    }
+    *c = next;
+    lval_del(f);
+    return 1;
 }
 
-lval* builtin_eval(lenv* e, lval* a) {
-    LASSERT_NUM("eval", a, 1);
-    LASSERT_TYPE("eval", a, 0, LVAL_QEXPR);
+/* Globals live in the outermost environment */
+lenv* lvm_global(lenv* e) {
+    while (e->parent) { e = e->parent; }
+    return e;
+}
 
-    lval* x = lval_take(a, 0);
-    x->type = LVAL_SEXPR;
-    return lval_eval(e, x);
+/* The value of a folded expression, evaluated again if a pure builtin has
+   been rebound since it was compiled */
+lval* lvm_folded(lenv* e, lchunk* c, int arg) {
+    if (c->epoch == lenv_epoch) { return lval_copy(c->consts[arg]); }
+    return lval_eval(e, lval_copy(c->consts[arg+1]));
 }
 
-lval* builtin_join(lenv* e, lval* a) {
-    for (int i = 0; i < a->count; i++) {
-        LASSERT_TYPE("join", a, i, LVAL_QEXPR);
+lval* lvm_local(lenv* e, int arg) {
+    for (int depth = arg >> LVM_LOCAL_BITS; depth > 0; depth--) {
+        e = e->parent;
     }
+    return lval_copy(e->vals[arg & ((1 << LVM_LOCAL_BITS) - 1)]);
+}
 
-    lval* x = lval_pop(a, 0);
-
-    while (a->count) {
-        lval* y = lval_pop(a, 0);
-        x = lval_join(x, y);
-    }
+lval* lvm_exec_switch(lenv* e, lchunk** cp, lenv** frame) {
+    lenv* g = lvm_global(e);
+    lchunk* c = *cp;
+    int* ip = c->code;
+    while (1) {
+        int op = *ip++;
+        int arg = *ip++;
+        switch (op) {
+            case LVM_CONST:
+                lvm.stack[lvm.sp++] = lval_copy(c->consts[arg]);
+            break;
 
-    lval_del(a);
-    return x;
-}
+            case LVM_GLOBAL:
+                lvm.stack[lvm.sp++] = lval_copy(g->vals[arg]);
+            break;
 
-lval* builtin_op(lenv* e, lval* a, char* op) {
-    /* Ensure all arguments are numbers */
-    for (int i = 0; i < a->count; i++) {
-        LASSERT_TYPE(op, a, i, LVAL_NUM);
-    }
+            case LVM_LOCAL:
+                lvm.stack[lvm.sp++] = lvm_local(e, arg);
+            break;
 
-    /* Pop the first element */
-    lval* x = lval_pop(a, 0);
+            case LVM_NAME:
+                lvm.stack[lvm.sp++] = lenv_get(e, c->consts[arg]);
+            break;
 
-    /* If no arguments and sub the perform unary negation */
-    if ((strcmp(op, "-") == 0) && a->count ==0) {
-        x->num = -x->num;
-    }
+            case LVM_FOLD: {
+                /* Evaluating the expression may move the stack */
+                lval* x = lvm_folded(e, c, arg);
+                lvm.stack[lvm.sp++] = x;
+            }
+            break;
 
-    while (a->count > 0) {
-        /* Pop the next element */
-        lval* y = lval_pop(a, 0);
+            case LVM_CALL: {
+                LVM_SAFEPOINT();
+                /* The call may run nested chunks that move the stack */
+                lval* x = lvm_call(e, arg);
+                lvm.stack[lvm.sp++] = x;
+            }
+            break;
 
-        if (strcmp(op, "+") == 0) { x->num += y->num; }
-        if (strcmp(op, "-") == 0) { x->num -= y->num; }
-        if (strcmp(op, "*") == 0) { x->num *= y->num; }
-        if (strcmp(op, "/") == 0) {
-            if (y->num == 0) {
-                lval_del(x);
-                lval_del(y);
-                x = lval_err("Error: Division by zero!");
-                break;
+            case LVM_TAIL: {
+                LVM_SAFEPOINT();
+                if (lvm_tail(&c, &e, frame, arg)) {
+                    *cp = c;
+                    ip = c->code;
+                    break;
+                }
+                lval* x = lvm_call(e, arg);
+                lvm.stack[lvm.sp++] = x;
             }
-            x->num /= y->num;
-        }
-        if (strcmp(op, "%") == 0) { x->num = (x->num % y->num); }
+            break;
 
-        lval_del(y);
+            case LVM_RET:
+                return lvm.stack[--lvm.sp];
+        }
     }
-    lval_del(a);
-    return x;
 }
 
-lval* builtin_add(lenv* e, lval* a) {
-    return builtin_op(e, a, "+");
-}
+#ifdef LVM_THREADED
+/* Threaded code: the chunk is decoded once into pairs of label address and
+   operand, and each instruction jumps straight to the next one's handler
+   instead of returning to a central switch */
+lval* lvm_exec_threaded(lenv* e, lchunk** cp, lenv** frame) {
+    static void* labels[] = {
+        [LVM_CONST] = &&op_const, [LVM_GLOBAL] = &&op_global,
+        [LVM_LOCAL] = &&op_local, [LVM_NAME] = &&op_name, [LVM_FOLD] = &&op_fold,
+        [LVM_CALL] = &&op_call, [LVM_TAIL] = &&op_tail, [LVM_RET] = &&op_ret
+    };
+    lenv* g = lvm_global(e);
+    lchunk* c = *cp;
+    void** ip;
+    int arg;
 
-lval* builtin_sub(lenv* e, lval* a) {
-    return builtin_op(e, a, "-");
-}
+    #define LVM_NEXT() do { \
+        void* op = ip[0]; arg = (int)(intptr_t)ip[1]; ip += 2; goto *op; \
+    } while (0)
 
-lval* builtin_mul(lenv* e, lval* a) {
-    return builtin_op(e, a, "*");
-}
+enter:
+    if (!c->thread) {
+        c->thread = malloc(sizeof(void*) * c->count);
+        for (int i = 0; i < c->count; i += 2) {
+            c->thread[i] = labels[c->code[i]];
+            c->thread[i+1] = (void*)(intptr_t)c->code[i+1];
+        }
+    }
 
-lval* builtin_div(lenv* e, lval* a) {
-    return builtin_op(e, a, "/");
-}
+    ip = c->thread;
+    LVM_NEXT();
 
-lval* builtin_mod(lenv* e, lval* a) {
-    return builtin_op(e, a, "%");
-}
+    op_const:
+        lvm.stack[lvm.sp++] = lval_copy(c->consts[arg]);
+        LVM_NEXT();
 
-lval* builtin_def(lenv* e, lval* a) {
+    op_global:
+        lvm.stack[lvm.sp++] = lval_copy(g->vals[arg]);
+        LVM_NEXT();
 
-    LASSERT_TYPE("def", a, 0, LVAL_QEXPR);
+    op_local:
+        lvm.stack[lvm.sp++] = lvm_local(e, arg);
+        LVM_NEXT();
 
-    /* First argument is symbol list */
-    lval* syms = a->cell[0];
+    op_name:
+        lvm.stack[lvm.sp++] = lenv_get(e, c->consts[arg]);
+        LVM_NEXT();
 
-    /* Ensure all elements of first list are symbols */
-    for (int i = 0; i < syms->count; i++) {
-        LASSERT(a, (syms->cell[i]->type == LVAL_SYM),
-            "Function 'def' cannot define non-symbol. "
-            "Got %s, Expected %s.",
-            ltype_name(syms->cell[i]->type), ltype_name(LVAL_SYM));
+    op_fold: {
+        lval* x = lvm_folded(e, c, arg);
+        lvm.stack[lvm.sp++] = x;
+        LVM_NEXT();
     }
 
-    /* Check correct number of symbols and values */
-    LASSERT(a, (syms->count == a->count-1),
-        "Function 'def' passed too many arguments for symbols. "
-        "Got %i, Expected %i.",
-        syms->count, a->count-1);
+    op_call: {
+        LVM_SAFEPOINT();
+        lval* x = lvm_call(e, arg);
+        lvm.stack[lvm.sp++] = x;
+        LVM_NEXT();
+    }
 
-    /* Assign copies of values to symbols */
-    for (int i = 0; i < syms->count; i++) {
-        lenv_put(e, syms->cell[i], a->cell[i+1]);
+    op_tail: {
+        LVM_SAFEPOINT();
+        if (lvm_tail(&c, &e, frame, arg)) {
+            *cp = c;
+            goto enter;
+        }
+        lval* x = lvm_call(e, arg);
+        lvm.stack[lvm.sp++] = x;
+        LVM_NEXT();
     }
 
-    lval_del(a);
-    return lval_sexpr();
+    op_ret:
+        return lvm.stack[--lvm.sp];
+
+    #undef LVM_NEXT
 }
+#endif
 
-void lenv_add_builtin(lenv* e, char* name, lbuiltin func) {
-    lval* k = lval_sym(name);
-    lval* v = lval_func(func);
-    lenv_put(e, k, v);
-    lval_del(k);
-    lval_del(v);
+/* Run a chunk, freeing it afterwards if nothing else holds it */
+lval* lvm_run(lenv* e, lchunk* c) {
+#ifdef LISPC_GC
+    /* The outermost run roots the whole operand stack */
+    if (lvm.depth == 0) { lgc_push_array(&lvm.stack, &lvm.sp); }
+#endif
+    lvm.depth++;
+    lvm_enter(c);
+
+    /* Tail calls may leave the run in another chunk and frame */
+    lenv* frame = NULL;
+#ifdef LVM_THREADED
+    lval* result = lvm.threaded
+        ? lvm_exec_threaded(e, &c, &frame) : lvm_exec_switch(e, &c, &frame);
+#else
+    lval* result = lvm_exec_switch(e, &c, &frame);
+#endif
+
+    lvm_leave(c);
+    if (frame) { lenv_del(frame); }
+    lvm.depth--;
+#ifdef LISPC_GC
+    if (lvm.depth == 0) { lgc_pop_array(); }
+#endif
+    return result;
 }
 
-void lenv_add_builtins(lenv* e) {
-    /* Variable functions */
-    lenv_add_builtin(e, "def", builtin_def);
-    /* List functions */
-    lenv_add_builtin(e, "list", builtin_list);
-    lenv_add_builtin(e, "head", builtin_head);
-    lenv_add_builtin(e, "tail", builtin_tail);
-    lenv_add_builtin(e, "eval", builtin_eval);
-    lenv_add_builtin(e, "join", builtin_join);
-    /* Mathematical functions */
-    lenv_add_builtin(e, "+", builtin_add);
-    lenv_add_builtin(e, "-", builtin_sub);
-    lenv_add_builtin(e, "*", builtin_mul);
-    lenv_add_builtin(e, "/", builtin_div);
-    lenv_add_builtin(e, "%", builtin_mod);
+/* Evaluate the children of a list as an S-expression, using the cached
+   chunk if the list is shared */
+lval* lvm_eval_list(lenv* e, lval* v) {
+    lchunk* c = lvm_chunk(e, v);
+    lval* result = lvm_run(e, c);
+    lval_del(v);
+    return result;
 }
 
+/* Evaluate a Q-expression as an S-expression. The VM can run it as it is
+   without copying it */
+lval* lval_eval_qexpr(lenv* e, lval* v) {
+    if (lvm.enabled) { return lvm_eval_list(e, v); }
 
-/* Evaluation */
+    v = lval_unshare(v);
+    v->type = LVAL_SEXPR;
+    return lval_eval_tree(e, v);
+}
 
-lval* lval_eval_sexpr(lenv* e, lval* v) {
-    /* Evaluate children */
-    for (int i = 0; i < v->count; i++) {
-        v->cell[i] = lval_eval(e, v->cell[i]);
+#ifdef LISPC_GC
+/* The constants of a lambda's code are traced along with the lambda */
+void lvm_evacuate(lchunk* c) {
+    for (int i = 0; i < c->nconsts; i++) {
+        c->consts[i] = lgc_evacuate(c->consts[i]);
     }
+}
 
-    /* Error checking */
-    for (int i = 0; i < v->count; i++) {
-        if (v->cell[i]->type == LVAL_ERR) { 
-            return lval_take(v, i); 
-        }
+void lvm_mark(lchunk* c) {
+    for (int i = 0; i < c->nconsts; i++) {
+        lgc_mark(c->consts[i]);
     }
+}
+#endif
 
-    /* Empty expression */
-    if (v->count == 0) {
-        return v;
+/* Compile the body of a lambda against its parameters and the frames
+   around it, unless the VM is disabled */
+void lvm_prepare(lfunc* f) {
+    if (!lvm.enabled) { return; }
+    if (f->code) {
+        if (f->code->epoch == lenv_epoch) { return; }
+        /* Compile again rather than run stale folds */
+        lvm_disown(f->code);
     }
 
-    /* Single expression */
-    if (v->count == 1) {
-        return lval_take(v, 0);
-    }
+    /* A frame with the parameters but no values yet */
+    lenv scope = { f->env, 1, f->count, f->params, NULL, 0, NULL, 0 };
+    f->code = lvm_compile_list(&scope, f->body);
+    f->code->owned = 1;
+}
 
-    /* Ensure first element is Symbol */
-    lval* f = lval_pop(v, 0);
-    if (f->type != LVAL_FUNC) {
-        lval_del(v);
-        lval_del(f);
-        return lval_err("Error: First element is not a function!");
+/* Apply a function to its argument list, which it takes ownership of */
+lval* lval_call(lenv* e, lval* f, lval* a) {
+    if (!f->lambda) { return f->func(e, a); }
+
+    lfunc* l = f->lambda;
+    LASSERT(a, lfunc_accepts(l, a->count),
+        "Function passed incorrect number of arguments. Got %i, Expected %s%i.",
+        a->count, l->variadic ? "at least " : "",
+        l->variadic ? l->count-1 : l->count);
+
+    /* Move the arguments into a new frame */
+    lenv* frame = lfunc_bind(l, a->cell, a->count);
+    a->count = 0;
+    lval_del(a);
+
+#ifdef LISPC_GC
+    lgc_push(&f);
+#endif
+
+    lval* result;
+    if (lvm.enabled) {
+        lvm_prepare(l);
+        result = lvm_run(frame, l->code);
+    } else {
+        result = lval_eval_qexpr(frame, lval_copy(l->body));
     }
 
-    /* Call builtin with operator */
-    lval* result = f->func(e, v);
-    lval_del(f);
+#ifdef LISPC_GC
+    lgc_pop();
+#endif
+    lenv_del(frame);
     return result;
 }
 
 lval* lval_eval(lenv* e, lval* v) {
+    if (!lvm.enabled) { return lval_eval_tree(e, v); }
+
+    /* Values evaluating to themselves skip compilation */
+    if (lval_is_imm(v)) { return v; }
+
     if (v->type == LVAL_SYM) {
         lval* x = lenv_get(e, v);
         lval_del(v);
@@ -544,7 +4220,7 @@ lval* lval_eval(lenv* e, lval* v) {
     }
 
     if (v->type == LVAL_SEXPR) {
-        return lval_eval_sexpr(e, v);
+        return lvm_eval_list(e, v);
     }
 
     return v;
@@ -553,16 +4229,64 @@ lval* lval_eval(lenv* e, lval* v) {
 
 /* Reading */
 
+/* mpc parses recursively, so input nested deeper than this is refused
+   rather than overflowing the C stack. Everything after parsing works
+   from explicit stacks and takes any depth. */
+#ifndef LISPC_MAX_NESTING
+#define LISPC_MAX_NESTING 5000
+#endif
+
+int lval_read_nesting(char* s) {
+    int depth = 0;
+    int max = 0;
+    for (; *s; s++) {
+        /* Brackets in a string literal do not nest */
+        if (*s == '"') {
+            for (s++; *s && *s != '"'; s++) {
+                if (*s == '\\' && s[1]) { s++; }
+            }
+            if (!*s) { break; }
+            continue;
+        }
+        if (*s == '(' || *s == '{') {
+            depth++;
+            if (depth > max) { max = depth; }
+        }
+        if (*s == ')' || *s == '}') { depth--; }
+    }
+    return max;
+}
+
 lval* lval_read_num(mpc_ast_t* t) {
     errno = 0;
     long x = strtol(t->contents, NULL, 10);
-    return errno != ERANGE ? lval_num(x) : lval_err("invalid number");
+    /* Literals too long for a long are read as big Numbers */
+    return errno != ERANGE ? lval_num(x) : lval_big(lbig_read(t->contents));
+}
+
+lval* lval_read_float(mpc_ast_t* t) {
+    return lval_float(strtod(t->contents, NULL));
+}
+
+lval* lval_read_str(mpc_ast_t* t) {
+    /* Cut off the final quote character */
+    t->contents[strlen(t->contents)-1] = '\0';
+    /* Copy the string missing out the first quote character */
+    char* unescaped = malloc(strlen(t->contents+1)+1);
+    strcpy(unescaped, t->contents+1);
+    /* Pass through the unescape function */
+    unescaped = mpcf_unescape(unescaped);
+    lval* str = lval_str(unescaped, strlen(unescaped));
+    free(unescaped);
+    return str;
 }
 
 lval* lval_read(mpc_ast_t* t) {
-    /* If Symbol or Number return conversion to that type */
+    /* If Symbol, Number or String return conversion to that type */
+    if (strstr(t->tag, "float")) { return lval_read_float(t); }
     if (strstr(t->tag, "number")) { return lval_read_num(t); }
     if (strstr(t->tag, "symbol")) { return lval_sym(t->contents); }
+    if (strstr(t->tag, "string")) { return lval_read_str(t); }
 
     /* If root (>) or sexpr then create empty list */
     lval* x = NULL;
@@ -582,13 +4306,297 @@ lval* lval_read(mpc_ast_t* t) {
     return x;
 }
 
+/* Benchmarks */
+
+/* Built with -DLISPC_BENCH, running 'lispc --bench' times the interpreter
+   internals directly instead of starting the REPL. */
+#ifdef LISPC_BENCH
+double bench_seconds(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* Define 10k global bindings, then look each of them up repeatedly */
+void bench_lenv(void) {
+    enum { BINDINGS = 10000, ROUNDS = 100 };
+
+    lenv* e = lenv_new();
+    lval** keys = malloc(sizeof(lval*) * BINDINGS);
+    char name[32];
+    for (int i = 0; i < BINDINGS; i++) {
+        snprintf(name, sizeof(name), "bench_%i", i);
+        keys[i] = lval_sym(name);
+    }
+
+    clock_t start = clock();
+    for (int i = 0; i < BINDINGS; i++) {
+        lval* v = lval_num(i);
+        lenv_put(e, keys[i], v);
+        lval_del(v);
+    }
+    double put = bench_seconds(start);
+
+    volatile long sink = 0;
+    start = clock();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < BINDINGS; i++) {
+            lval* v = lenv_get(e, keys[i]);
+            sink += lval_num_get(v);
+            lval_del(v);
+        }
+    }
+    double get = bench_seconds(start);
+
+    printf("lenv: %i bindings, put %.1f ns/op, get %.1f ns/op\n", BINDINGS,
+        put * 1e9 / BINDINGS, get * 1e9 / ((double)BINDINGS * ROUNDS));
+
+    for (int i = 0; i < BINDINGS; i++) { lval_del(keys[i]); }
+    free(keys);
+    lenv_del(e);
+}
+
+/* Walk a large Q-expression of boxed values, touching each value */
+void bench_walk(void) {
+    enum { ELEMS = 1000000, ROUNDS = 20 };
+
+    /* Interleave allocations so consecutive elements are not adjacent */
+    lval* q = lval_qexpr();
+    lval* other = lval_qexpr();
+    for (int i = 0; i < ELEMS; i++) {
+        lval_add(q, lval_num(LONG_MAX - i));
+        lval_add(other, lval_sym("bench"));
+    }
+
+    volatile long sink = 0;
+    clock_t start = clock();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < q->count; i++) {
+            sink += lval_num_get(q->cell[i]);
+        }
+    }
+    double walk = bench_seconds(start);
+
+    printf("walk: sizeof(lval) %i bytes, %.2f ns/element\n", (int)sizeof(lval),
+        walk * 1e9 / ((double)ELEMS * ROUNDS));
+
+    lval_del(q);
+    lval_del(other);
+}
+
+/* Evaluate a shared body of nested arithmetic repeatedly, as 'eval' does
+   for a defined Q-expression, with each evaluator. The body is all
+   constants, so folding is held off to compare dispatch and then timed on
+   its own. */
+void bench_eval(void) {
+    enum { TERMS = 100, ROUNDS = 20000 };
+
+    lenv* e = lenv_new();
+    lenv_add_builtins(e);
+
+    /* {+ (* i (+ 1 2) (- 5 i)) ...} */
+    lval* body = lval_qexpr();
+    lval_add(body, lval_sym("+"));
+    for (int i = 0; i < TERMS; i++) {
+        lval* sum = lval_sexpr();
+        lval_add(sum, lval_sym("+"));
+        lval_add(sum, lval_num(1));
+        lval_add(sum, lval_num(2));
+        lval* sub = lval_sexpr();
+        lval_add(sub, lval_sym("-"));
+        lval_add(sub, lval_num(5));
+        lval_add(sub, lval_num(i));
+        lval* mul = lval_sexpr();
+        lval_add(mul, lval_sym("*"));
+        lval_add(mul, lval_num(i));
+        lval_add(mul, sum);
+        lval_add(mul, sub);
+        lval_add(body, mul);
+    }
+
+    struct { const char* name; int enabled; int threaded; int fold; } modes[] = {
+        { "tree", 0, 0, 0 }, { "switch", 1, 0, 0 }, { "threaded", 1, 1, 0 },
+        { "folded", 1, 0, 1 }
+    };
+
+    for (int m = 0; m < 4; m++) {
+#ifndef LVM_THREADED
+        if (modes[m].threaded) { continue; }
+#endif
+        lvm.enabled = modes[m].enabled;
+        lvm.threaded = modes[m].threaded;
+        lvm.fold = modes[m].fold;
+
+        /* Compile the body again under this mode's folding */
+        lvm_flush();
+
+        volatile long sink = 0;
+        clock_t start = clock();
+        for (int r = 0; r < ROUNDS; r++) {
+            lval* x = lval_eval_qexpr(e, lval_copy(body));
+            sink += lval_num_get(x);
+            lval_del(x);
+        }
+        double run = bench_seconds(start);
+
+        /* Each term is three calls, plus the outer sum */
+        printf("eval: %-8s %.1f ns/call\n", modes[m].name,
+            run * 1e9 / ((double)(TERMS * 3 + 1) * ROUNDS));
+    }
+    lvm.enabled = 1;
+    lvm.threaded = 1;
+    lvm.fold = 1;
+
+    lval_del(body);
+    lenv_del(e);
+}
+
+/* Multiply big Numbers of growing size, limb by limb and by Karatsuba */
+void bench_big(void) {
+    int sizes[] = { 16, 64, 256, 1024 };
+    int threshold = lbig_karatsuba;
+
+    for (int s = 0; s < 4; s++) {
+        int n = sizes[s];
+        int rounds = 2000000 / (n * n) + 1;
+        lbig x = lbig_alloc(n), y = lbig_alloc(n);
+        for (int i = 0; i < n; i++) {
+            x.d[i] = (uint32_t)rand() * 2654435761u;
+            y.d[i] = (uint32_t)rand() * 2246822519u;
+        }
+        x.n = y.n = n;
+        x.d[n-1] |= 1;
+        y.d[n-1] |= 1;
+
+        double times[2];
+        for (int k = 0; k < 2; k++) {
+            lbig_karatsuba = k == 0 ? INT_MAX : threshold;
+            clock_t start = clock();
+            for (int r = 0; r < rounds; r++) { free(lbig_mul(x, y).d); }
+            times[k] = bench_seconds(start) * 1e6 / rounds;
+        }
+        printf("big: %4i limbs, schoolbook %.1f us/mul, karatsuba %.1f us/mul\n",
+            n, times[0], times[1]);
+
+        free(x.d);
+        free(y.d);
+    }
+    lbig_karatsuba = threshold;
+}
+
+/* Run each reduction kernel over a million elements, then '+' over a long
+   argument list with and without the kernels */
+void bench_simd(void) {
+    enum { ELEMS = 1 << 20, ROUNDS = 200, ARGS = 4096, CALLS = 2000 };
+
+    int64_t* ints = malloc(sizeof(int64_t) * ELEMS);
+    double* floats = malloc(sizeof(double) * ELEMS);
+    for (int i = 0; i < ELEMS; i++) {
+        ints[i] = ((int64_t)rand() << 32) ^ rand();
+        floats[i] = 1.0 + (rand() % 1000) * 1e-9;
+    }
+
+    lsimd_kernels* best = lsimd;
+    for (int level = 0; level <= 2; level++) {
+        lsimd_init(level);
+        if (level > 0 && lsimd == &lsimd_scalar) { break; }
+#ifdef LSIMD_X86
+        if (level == 2 && lsimd != &lsimd_avx2) { break; }
+#endif
+
+        volatile double sink = 0;
+        double t[5];
+        clock_t start = clock();
+        for (int r = 0; r < ROUNDS; r++) {
+            uint64_t acc[3] = { 0, 0, 0 };
+            lsimd->sum(ints, ELEMS, acc);
+            sink += acc[0];
+        }
+        t[0] = bench_seconds(start);
+        start = clock();
+        for (int r = 0; r < ROUNDS; r++) { sink += lsimd->min(ints, ELEMS); }
+        t[1] = bench_seconds(start);
+        start = clock();
+        for (int r = 0; r < ROUNDS; r++) { sink += lsimd->max(ints, ELEMS); }
+        t[2] = bench_seconds(start);
+        start = clock();
+        for (int r = 0; r < ROUNDS; r++) { sink += lsimd->fsum(floats, ELEMS); }
+        t[3] = bench_seconds(start);
+        start = clock();
+        for (int r = 0; r < ROUNDS; r++) { sink += lsimd->fprod(floats, ELEMS); }
+        t[4] = bench_seconds(start);
+
+        double elems = (double)ELEMS * ROUNDS / 1e6;
+        printf("simd: %-6s sum %.0f, min %.0f, max %.0f, fsum %.0f, fprod %.0f Melem/s\n",
+            lsimd->name, elems / t[0], elems / t[1], elems / t[2],
+            elems / t[3], elems / t[4]);
+    }
+    lsimd = best;
+
+    /* (+ 0 1 2 ...) as builtin_op sees it */
+    lval* args = lval_sexpr();
+    for (int i = 0; i < ARGS; i++) { lval_add(args, lval_num(i)); }
+
+    int threshold = lsimd_min_args;
+    for (int k = 0; k < 2; k++) {
+        lsimd_min_args = k == 0 ? INT_MAX : threshold;
+        volatile long sink = 0;
+        clock_t start = clock();
+        for (int r = 0; r < CALLS; r++) {
+            lval* x = builtin_add(NULL, lval_copy(args));
+            sink += lval_num_get(x);
+            lval_del(x);
+        }
+        double run = bench_seconds(start);
+        printf("simd: '+' over %i arguments %s, %.0f Melem/s\n", ARGS,
+            k == 0 ? "folded one by one" : "through the kernels",
+            (double)ARGS * CALLS / 1e6 / run);
+    }
+    lsimd_min_args = threshold;
+
+    lval_del(args);
+    free(ints);
+    free(floats);
+}
+
+void bench_run(void) {
+    bench_lenv();
+    bench_walk();
+    bench_eval();
+    bench_big();
+    bench_simd();
+}
+#endif
+
+
 /* Main */
 
 int main(int argc, char** argv) {
 
+    int simd = 2;
+    for (int i = 1; i < argc; i++) {
+        /* Evaluate with the tree walker instead of the bytecode VM */
+        if (strcmp(argv[i], "--no-vm") == 0) { lvm.enabled = 0; }
+        /* Run the VM through its switch rather than threaded code */
+        if (strcmp(argv[i], "--switch") == 0) { lvm.threaded = 0; }
+        /* Leave calls on constants to be made when run */
+        if (strcmp(argv[i], "--no-fold") == 0) { lvm.fold = 0; }
+        /* Hold the reduction kernels back to SSE2, or to plain C */
+        if (strcmp(argv[i], "--no-avx2") == 0 && simd > 1) { simd = 1; }
+        if (strcmp(argv[i], "--no-simd") == 0) { simd = 0; }
+    }
+    lsimd_init(simd);
+
+#ifdef LISPC_BENCH
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        bench_run();
+        return 0;
+    }
+#endif
+
     /* Create Parsers */
+    mpc_parser_t* Float     = mpc_new("float");
     mpc_parser_t* Number    = mpc_new("number");
     mpc_parser_t* Symbol    = mpc_new("symbol");
+    mpc_parser_t* String    = mpc_new("string");
     mpc_parser_t* Sexpr     = mpc_new("sexpr");
     mpc_parser_t* Qexpr     = mpc_new("qexpr");
     mpc_parser_t* Expr      = mpc_new("expr");
@@ -597,19 +4605,26 @@ int main(int argc, char** argv) {
     /* Define parsers with the following Language */
     mpca_lang(MPCA_LANG_DEFAULT,
         "                                                       \
+            float  : /-?[0-9]+(\\.[0-9]+([eE][-+]?[0-9]+)?|[eE][-+]?[0-9]+)/ ; \
             number : /-?[0-9]+/ ;                               \
             symbol : /[a-zA-Z0-9_+\\-*\\/\\\\=<>!&]+/ ;         \
+            string : /\"(\\\\.|[^\"])*\"/ ;                     \
             sexpr  : '(' <expr>* ')' ;                          \
             qexpr  : '{' <expr>* '}' ;                          \
-            expr   : <number> | <symbol> | <sexpr> | <qexpr> ;  \
+            expr   : <float> | <number> | <string> | <symbol>      \
+                   | <sexpr> | <qexpr> ;                        \
             lispc  : /^/ <expr>* /$/ ;                          \
         ",
-        Number, Symbol, Sexpr, Qexpr, Expr, Lispc);
+        Float, Number, Symbol, String, Sexpr, Qexpr, Expr, Lispc);
 
     /* Print version and exit information */
     puts("Lispc Version 0.0.5");
     puts("Press Ctrl+c to Exit\n");
 
+#ifdef LISPC_GC
+    lgc_stats.verbose = getenv("LISPC_GC_STATS") != NULL;
+#endif
+
     /* Create environment */
     lenv* e = lenv_new();
     lenv_add_builtins(e);
@@ -620,12 +4635,19 @@ int main(int argc, char** argv) {
         /* Output our prompt and get input */
         char* input = readline("lispc> ");
 
+        /* Stop at the end of input */
+        if (!input) { break; }
+
         /* Add input to history */
         add_history(input);
 
         /* Parse the user input */
         mpc_result_t r;
-        if (mpc_parse("<stdin>", input, Lispc, &r)) {
+        if (lval_read_nesting(input) > LISPC_MAX_NESTING) {
+            lval* err = lval_err("Input nested more than %i deep", LISPC_MAX_NESTING);
+            lval_println(err);
+            lval_del(err);
+        } else if (mpc_parse("<stdin>", input, Lispc, &r)) {
             lval* result = lval_eval(e, lval_read(r.output));
             lval_println(result);
             lval_del(result);
@@ -638,11 +4660,16 @@ int main(int argc, char** argv) {
 
         /* Free retrieved input */
         free(input);
+
+#ifdef LISPC_ARENA
+        /* Let go of everything the evaluation made that is not bound */
+        lgc_collect();
+#endif
     }
 
     lenv_del(e);
 
-    mpc_cleanup(6, Number, Symbol, Sexpr, Qexpr, Expr, Lispc);
+    mpc_cleanup(8, Float, Number, String, Symbol, Sexpr, Qexpr, Expr, Lispc);
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
++ 9223372036854775807 1
+- -9223372036854775807 1 1
+* 4294967296 4294967296
+- (+ 9223372036854775807 1) 1
+* 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30
+/ (* 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30) (* 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25)
+- 123456789012345678901234567890
+def {a b} -17138870672395553267893496900680375794366118397162846427591334167095113382447041774588194011319810789924773929897430990174607014680850469348008397036464977967149598402045447448256566945302355083246996614394153123257495495151539668069788932383737217537062222775067375278461348110296738428361914092346276812190404277091047722772030939439208300426106919544312963335 11760656507696767822067198663280022785823942641721556905820221036563799945299782859269082072804220772933011488776393479362369104362920674609960259905659504541727735768052548886332921674138991343065209705472065692593285027404944269881483606481207672567696185480624167730162134750138130818734307849448330314924530265680149643449268505
+* a b
+/ (* a b) b
+- (* a b) (* b a)
+def {a b} -25113386627265848806425358453256602661657999784911730135501391957873985095566694863474908939457053311207047878368527692147686048129530653088855702701881196485243856396146424131890579106642796966646487393918863317661444580215264209081850325435704761517529949184315499513593778131141075644840241525363377202045463090156592644775226329479439029217093160937161255839063608611499419858945045868398681372664497625661857858320965317730885211519027628654363612 800987870395311539199107118129434294195977132643410606839801252617835074539334693680867834935220309108329793415449391370248017133624513494036708184140425642983118207268704342342526218637912287626922241216753954027294859561205375093684446053274886229118747813629065621917547112868262100423534514839916580731449378967210301539274807527338281193431475910175102377007502346188800196357125675246
+* a b
+/ (* a b) b
+- (* a b) (* b a)
+def {a b} -37580226646790273343996798453548564712678145598119915650473826361587552590079360075058189960396875674967298301220537444460132694009446124212759410312182881201680900233388522951124801122927135083705555222455590147808238670912289914150043080021533155183458938447375610423334055188028737966097640112394405667555007174641705777976207641709140425039376861216658569853969421312462412993870181183568675833995171981055228990992638970562226067355434083597769213731721981657724434824535634810437306886356293593029005338253527375174367619011888538590401 33626532239278215835442776292990465398557040587478350124610319445716587254830523449520453547058772295860590134715463636721696203891455795544366372518438090752651159850269274463536894601915796527476126693447493557040987435888598246215223645529589488990340543222177019719583038590527732230736159952165351977892306572908849799793929588243993190717589827157342984611328092417020758739003633059313047789604890077626021615585742205193462737402605053297992083
+* a b
+/ (* a b) b
+- (* a b) (* b a)
+/ 49354003596132252920111659681269018013115112556122801710374664520856358 49513257592788815035951
+/ -85958444120632404646780224773008339214496910841423126458315860591971995804923959498123020745134862756610709767070792 515104834008414484567105889033690529460011
+/ -261588548381431759530312243155382893618986157168152085180898148683905671747803791205474237791237588561981576548045978360286321711618421770811000844096724697500805749350660945001087099041 896675510441304607
+/ -556157918040763864380725869814347659478788872817922709362968019485845074843903 74339614943603514891339571
+/ 1545825419035074603944898820978415816101757286449787508122875423092620693574455772119306668558923902864541941589075916665466032204684316792885796053271567612349281849052275568736433501824 4187304595575257540955791351973507521264782737561180418607657
+/ 21457734141810105026260568849057353998382952958223307 2920911718131152736941619359993975642189974500540826453099212457199188344281409
+/ 115792089237316195423570985008687907853269984665640564039457584007913129639935 340282366920938463463374607431768211455
+/ 6277101735386680763835789423207666416102355444464034512896 79228162532711081667253501951
+/ 6277101735386680763495507056286727952638980837032266301440 340282366920938463444927863358058659841
+/ 340282366920938463463374607431768211456 0
@@ -0,0 +1,88 @@
+1.5
+- 1.5 1.5
+0.1
+- 0.1 0.1
+-25000000000.0
+- -25000000000.0 -25000000000.0
+1e+300
+- 1e+300 1e+300
+-0.0
+- -0.0 -0.0
+5e-324
+- 5e-324 5e-324
+-5e-324
+- -5e-324 -5e-324
+2.2250738585072014e-308
+- 2.2250738585072014e-308 2.2250738585072014e-308
+1.7976931348623157e+308
+- 1.7976931348623157e+308 1.7976931348623157e+308
+-1.7976931348623157e+308
+- -1.7976931348623157e+308 -1.7976931348623157e+308
+1e+16
+- 10000000000000000.0 1e+16
+1000000000000000.0
+- 1000000000000000.0 1000000000000000.0
+123456789.125
+- 123456789.125 123456789.125
+0.5
+- 0.5 0.5
+1e-07
+- 1e-07 1e-07
+1e+22
+- 1e+22 1e+22
+9007199254740992.0
+- 9007199254740992.0 9007199254740992.0
+-4.611686018427388e+18
+- -4.611686018427388e+18 -4.611686018427388e+18
+-2.2783812563554847e+194
+- -2.2783812563554847e+194 -2.2783812563554847e+194
+1.638642235562844e-09
+- 1.638642235562844e-09 1.638642235562844e-09
+-3.189766644380271e-169
+- -3.189766644380271e-169 -3.189766644380271e-169
+2.489837563768064e+243
+- 2.489837563768064e+243 2.489837563768064e+243
+-1.1980331680792192e-59
+- -1.1980331680792192e-59 -1.1980331680792192e-59
+-3.1245429867392275e-13
+- -3.1245429867392275e-13 -3.1245429867392275e-13
+-8.126370367254644e+158
+- -8.126370367254644e+158 -8.126370367254644e+158
+-6.67806841323834e+52
+- -6.67806841323834e+52 -6.67806841323834e+52
+1.942062806980385e-210
+- 1.942062806980385e-210 1.942062806980385e-210
+1.1563659911917338e+24
+- 1.1563659911917338e+24 1.1563659911917338e+24
+2.0205796311937487e-247
+- 2.0205796311937487e-247 2.0205796311937487e-247
+-1.2792676659531598e+279
+- -1.2792676659531598e+279 -1.2792676659531598e+279
+8.740682149153437e-88
+- 8.740682149153437e-88 8.740682149153437e-88
+-1.45346479600776e-244
+- -1.45346479600776e-244 -1.45346479600776e-244
+-3.2083745936624727e-21
+- -3.2083745936624727e-21 -3.2083745936624727e-21
+1.915889286844411e+222
+- 1.915889286844411e+222 1.915889286844411e+222
+-1.073408063218639e+165
+- -1.073408063218639e+165 -1.073408063218639e+165
+-1.4728164087344782e-213
+- -1.4728164087344782e-213 -1.4728164087344782e-213
+2.27385737144604e-282
+- 2.27385737144604e-282 2.27385737144604e-282
+3.549142691647543e+17
+- 3.549142691647543e+17 3.549142691647543e+17
++ 0.1 0.2
+* 3 0.5
+/ 7.5 2
+- 4.0 4
++ 9223372036854775807 1.0
+* 1e300 1e300
+- 0 (* 1e300 1e300)
+- (* 1e300 1e300) (* 1e300 1e300)
+list 1.0 2 -0.0
+eval {+ 1.25 1.25}
+/ 0.0 0.0
+head {2.5 1}
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Run each tests/NAME.lsp that has its expected output in tests/NAME.out,
+# through the VM, the tree walker and the reduction kernels held back to
+# SSE2 and to plain C, and compare what is printed after the banner. Build
+# lispc with -DLISPC_GC or -DLISPC_ARENA to run them under the collectors.
+#
+# Usage: tests/run.sh [path to lispc]
+
+LISPC=${1:-./lispc}
+DIR=$(dirname "$0")
+OUT=$(mktemp)
+trap 'rm -f "$OUT"' EXIT
+
+status=0
+for test in "$DIR"/*.lsp; do
+    name=$(basename "$test" .lsp)
+    [ -f "$DIR/$name.out" ] || continue
+    for mode in "" --no-vm --no-avx2 --no-simd; do
+        "$LISPC" $mode < "$test" 2>&1 | tail -n +4 | sed 's/^\(lispc> \)*//' > "$OUT"
+        if diff "$DIR/$name.out" "$OUT" > /dev/null; then
+            echo "ok   $name ${mode:-vm}"
+        else
+            echo "FAIL $name ${mode:-vm}"
+            diff "$DIR/$name.out" "$OUT" | head -20
+            status=1
+        fi
+    done
+done
+exit $status
@@ -0,0 +1,52 @@
++ 493891 -197083 761187 222175 -617078 -542259 -649085 -592953 -644798 406951 429526 -807510 480348 589089 -682701 691109
+min 493891 -197083 761187 222175 -617078 -542259 -649085 -592953 -644798 406951 429526 -807510 480348 589089 -682701 691109
+max 493891 -197083 761187 222175 -617078 -542259 -649085 -592953 -644798 406951 429526 -807510 480348 589089 -682701 691109
+* 3 1 -1 -1 1 1 -2 2 -1 -1 3 -1 1 3 -2 2
++ 428587 -314503 -359618 -843771 136837 361015 -230351 385707 874205 -930251 939094 -551779 -336947 -289213 876489 558206 -854017
+min 428587 -314503 -359618 -843771 136837 361015 -230351 385707 874205 -930251 939094 -551779 -336947 -289213 876489 558206 -854017
+max 428587 -314503 -359618 -843771 136837 361015 -230351 385707 874205 -930251 939094 -551779 -336947 -289213 876489 558206 -854017
+* 3 1 2 -2 2 -1 3 3 -2 3 2 1 -2 -1 2 2 3
++ 5692 -584920 405891 267365 643066 -724542 -2106 59995 -456052 67115 604335 -526612 115888 670005 -491218 -822729 323234 -713479 -452730 -342771 350402 136915 360406 -516820 -179455 -566833 666757 -358282 -153729 -860468 -16677
+min 5692 -584920 405891 267365 643066 -724542 -2106 59995 -456052 67115 604335 -526612 115888 670005 -491218 -822729 323234 -713479 -452730 -342771 350402 136915 360406 -516820 -179455 -566833 666757 -358282 -153729 -860468 -16677
+max 5692 -584920 405891 267365 643066 -724542 -2106 59995 -456052 67115 604335 -526612 115888 670005 -491218 -822729 323234 -713479 -452730 -342771 350402 136915 360406 -516820 -179455 -566833 666757 -358282 -153729 -860468 -16677
+* 3 3 3 2 -2 -1 3 2 3 1 1 -1 3 -1 -1 1 1 1 3 -1 -1 -2 -1 -2 -2 -1 -1 2 3 3 3
++ -383770 -694270 -295083 561613 902516 -867107 674401 213726 344507 685498 -963941 910141 -449846 939530 139205 -967756 451443 354182 -120745 -160675 326819 -175898 898160 -389424 -438986 -54878 -198821 421282 594348 -221162 -331897 827366 512739
+min -383770 -694270 -295083 561613 902516 -867107 674401 213726 344507 685498 -963941 910141 -449846 939530 139205 -967756 451443 354182 -120745 -160675 326819 -175898 898160 -389424 -438986 -54878 -198821 421282 594348 -221162 -331897 827366 512739
+max -383770 -694270 -295083 561613 902516 -867107 674401 213726 344507 685498 -963941 910141 -449846 939530 139205 -967756 451443 354182 -120745 -160675 326819 -175898 898160 -389424 -438986 -54878 -198821 421282 594348 -221162 -331897 827366 512739
+* 1 -1 1 -1 -1 1 2 2 2 -2 -2 2 -1 2 2 1 1 1 1 2 1 -2 -1 1 2 3 3 1 2 1 2 -2 1
++ 252296 674553 95941 41103 94120 476586 -358020 -466037 438595 371679 927070 -48800 -34231 359707 -206305 -138599 924416 383230 774667 550196 746338 -675778 -284344 -830372 -599262 113463 -678330 -619084 -723995 -75379 -285390 -408315 825710 781391 -513054 344849 299644 -716412 -477383 -790698 -355856 567798 335443 275864 268186 983684 879585 -502048 928185 -432786 -31926 -868286 -606044 -551155 -210338 309571 182408 690160 -2786 229907 -285206 593231 -45449 445299 829116 -673639 809499 -902866 954777 -636175 -646041 713664 -602237 536999 729993 -525166 -973574 -508863 -421103 -355595 -2316 424497 304104 569436 218901 -500253 871808 -310056 -446484 -502581 -385858 983170 -5677 157042 -407121 970742 -937821 -492110 -277894 326664
+min 252296 674553 95941 41103 94120 476586 -358020 -466037 438595 371679 927070 -48800 -34231 359707 -206305 -138599 924416 383230 774667 550196 746338 -675778 -284344 -830372 -599262 113463 -678330 -619084 -723995 -75379 -285390 -408315 825710 781391 -513054 344849 299644 -716412 -477383 -790698 -355856 567798 335443 275864 268186 983684 879585 -502048 928185 -432786 -31926 -868286 -606044 -551155 -210338 309571 182408 690160 -2786 229907 -285206 593231 -45449 445299 829116 -673639 809499 -902866 954777 -636175 -646041 713664 -602237 536999 729993 -525166 -973574 -508863 -421103 -355595 -2316 424497 304104 569436 218901 -500253 871808 -310056 -446484 -502581 -385858 983170 -5677 157042 -407121 970742 -937821 -492110 -277894 326664
+max 252296 674553 95941 41103 94120 476586 -358020 -466037 438595 371679 927070 -48800 -34231 359707 -206305 -138599 924416 383230 774667 550196 746338 -675778 -284344 -830372 -599262 113463 -678330 -619084 -723995 -75379 -285390 -408315 825710 781391 -513054 344849 299644 -716412 -477383 -790698 -355856 567798 335443 275864 268186 983684 879585 -502048 928185 -432786 -31926 -868286 -606044 -551155 -210338 309571 182408 690160 -2786 229907 -285206 593231 -45449 445299 829116 -673639 809499 -902866 954777 -636175 -646041 713664 -602237 536999 729993 -525166 -973574 -508863 -421103 -355595 -2316 424497 304104 569436 218901 -500253 871808 -310056 -446484 -502581 -385858 983170 -5677 157042 -407121 970742 -937821 -492110 -277894 326664
+* -2 -2 3 2 3 2 -2 -1 3 1 1 3 -1 -1 3 -1 -1 -2 -1 2 1 1 2 -2 1 3 -2 1 -2 3 2 -2 2 3 2 1 -2 2 -2 3
++ 281245 321096 483445 -222950 -671018 -416814 89489 781758 -60155 -396987 823436 844792 -656244 -402730 776126 214885 -701708 -200800 280574 -966200 869746 772552 -840261 -493546 14182 918646 -990690 -481676 67766 618703 18482 999586 607224 19403 -707842 907507 126765 529264 -516867 765369 261513 -265597 987503 -799235 269396 336897 363961 -764428 -280001 313278 532575 -624055 387778 267407 606988 -520986 212641 -578050 -280570 -633430 259549 -117247 -516344 576422 -466069 -3648 -200356 172492 -869978 -18995 131291 -236623 -356489 -584254 -14153 764462 550390 659149 399326 547582 -486578 358039 -655347 125250 727427 603784 784355 -992866 986480 -410798 838420 411208 -709559 168946 -847470 57761 107055 109766 569093 295045 -487990 543326 932080 750634 -53173 632359 313444 901289 -339868 207198 -598045 -640260 -999962 -224865 263769 807520 619257 -3012 299581 -908462 -732396 395662 -663598 -281093 375667 -415555 -114535 -606118 351071 -738520 -514882 -89609 942967 797528 303383 -377901 983153 625428 496088 -578338 1249 -522330 -541965 809556 -437557 -89390 -681787 56073 183567 567295 642528 264283 -513203 508645 667660 93543 -756790 -422186 -766008 513466 -977997 -735068 -246420 518420 201576 669317 -134985 -702150 98799 -994986 -252083 917122 314549 -608909 -138314 118024 920205 -391901 414792 -712528 720882 -458635 -846124 -565616 775206 -790109 613899 -93330 643146 -366171 -691882 259797 -321363 516055 -795731 844223 780459 -509675 -149174 989113 -498816 768192 -662668 285733 660646 43417 857797 -759609 571737 -931592 -800751 298275 895487 -418574 -124533 -90116 94014 -13650 848099 -791429 -407087 -237991 538833 258122 268316 -90099 -177999 -182942 862646 -667280 922705 -693240 -376388 728732 -801128 717366 -14091 -981705 718481 586340 787226 -703669 -965668 208348 649559 930325 621469 898864 357745 859626 827069 -71445 324295 855602 -934270 -467485 -848465
+min 281245 321096 483445 -222950 -671018 -416814 89489 781758 -60155 -396987 823436 844792 -656244 -402730 776126 214885 -701708 -200800 280574 -966200 869746 772552 -840261 -493546 14182 918646 -990690 -481676 67766 618703 18482 999586 607224 19403 -707842 907507 126765 529264 -516867 765369 261513 -265597 987503 -799235 269396 336897 363961 -764428 -280001 313278 532575 -624055 387778 267407 606988 -520986 212641 -578050 -280570 -633430 259549 -117247 -516344 576422 -466069 -3648 -200356 172492 -869978 -18995 131291 -236623 -356489 -584254 -14153 764462 550390 659149 399326 547582 -486578 358039 -655347 125250 727427 603784 784355 -992866 986480 -410798 838420 411208 -709559 168946 -847470 57761 107055 109766 569093 295045 -487990 543326 932080 750634 -53173 632359 313444 901289 -339868 207198 -598045 -640260 -999962 -224865 263769 807520 619257 -3012 299581 -908462 -732396 395662 -663598 -281093 375667 -415555 -114535 -606118 351071 -738520 -514882 -89609 942967 797528 303383 -377901 983153 625428 496088 -578338 1249 -522330 -541965 809556 -437557 -89390 -681787 56073 183567 567295 642528 264283 -513203 508645 667660 93543 -756790 -422186 -766008 513466 -977997 -735068 -246420 518420 201576 669317 -134985 -702150 98799 -994986 -252083 917122 314549 -608909 -138314 118024 920205 -391901 414792 -712528 720882 -458635 -846124 -565616 775206 -790109 613899 -93330 643146 -366171 -691882 259797 -321363 516055 -795731 844223 780459 -509675 -149174 989113 -498816 768192 -662668 285733 660646 43417 857797 -759609 571737 -931592 -800751 298275 895487 -418574 -124533 -90116 94014 -13650 848099 -791429 -407087 -237991 538833 258122 268316 -90099 -177999 -182942 862646 -667280 922705 -693240 -376388 728732 -801128 717366 -14091 -981705 718481 586340 787226 -703669 -965668 208348 649559 930325 621469 898864 357745 859626 827069 -71445 324295 855602 -934270 -467485 -848465
+max 281245 321096 483445 -222950 -671018 -416814 89489 781758 -60155 -396987 823436 844792 -656244 -402730 776126 214885 -701708 -200800 280574 -966200 869746 772552 -840261 -493546 14182 918646 -990690 -481676 67766 618703 18482 999586 607224 19403 -707842 907507 126765 529264 -516867 765369 261513 -265597 987503 -799235 269396 336897 363961 -764428 -280001 313278 532575 -624055 387778 267407 606988 -520986 212641 -578050 -280570 -633430 259549 -117247 -516344 576422 -466069 -3648 -200356 172492 -869978 -18995 131291 -236623 -356489 -584254 -14153 764462 550390 659149 399326 547582 -486578 358039 -655347 125250 727427 603784 784355 -992866 986480 -410798 838420 411208 -709559 168946 -847470 57761 107055 109766 569093 295045 -487990 543326 932080 750634 -53173 632359 313444 901289 -339868 207198 -598045 -640260 -999962 -224865 263769 807520 619257 -3012 299581 -908462 -732396 395662 -663598 -281093 375667 -415555 -114535 -606118 351071 -738520 -514882 -89609 942967 797528 303383 -377901 983153 625428 496088 -578338 1249 -522330 -541965 809556 -437557 -89390 -681787 56073 183567 567295 642528 264283 -513203 508645 667660 93543 -756790 -422186 -766008 513466 -977997 -735068 -246420 518420 201576 669317 -134985 -702150 98799 -994986 -252083 917122 314549 -608909 -138314 118024 920205 -391901 414792 -712528 720882 -458635 -846124 -565616 775206 -790109 613899 -93330 643146 -366171 -691882 259797 -321363 516055 -795731 844223 780459 -509675 -149174 989113 -498816 768192 -662668 285733 660646 43417 857797 -759609 571737 -931592 -800751 298275 895487 -418574 -124533 -90116 94014 -13650 848099 -791429 -407087 -237991 538833 258122 268316 -90099 -177999 -182942 862646 -667280 922705 -693240 -376388 728732 -801128 717366 -14091 -981705 718481 586340 787226 -703669 -965668 208348 649559 930325 621469 898864 357745 859626 827069 -71445 324295 855602 -934270 -467485 -848465
+* 2 -2 3 -1 2 3 1 -2 -2 3 1 3 -2 3 3 -2 -2 3 3 2 -2 2 2 2 2 -1 -1 -1 -2 1 -1 3 -1 1 3 -1 2 -1 1 3
++ 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328 140737488355328
++ 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 4611686018427387904 -5 -5 -5 -5 -5 -5 -5 -5 -5
++ -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904 -4611686018427387904
+* 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776 1099511627776
++ 16 24 59 80 41 20 98 81 72 3 27 92 21 75 40 82 10 86 21 12 1000000000000000000000000000000
+min 71 70 97 75 29 86 29 25 92 44 65 72 56 31 80 56 97 30 61 37 -1000000000000000000000000000000
++ 356.742 -594.237 831.364 754.211 -193.173 -998.171 333.944 -351.357 -744.725 817.654 -199.692 -671.303 -432.553 990.744 -297.487 -56.206
+* 0.9503 0.9163 0.9264 0.9118 0.9911 0.9862 1.0407 1.0667 1.0748 0.928 1.0116 0.9286 0.9593 0.9774 0.9786 1.0687
+max 356.742 -594.237 831.364 1959 -193.173 -998.171 333.944 -351.357 -744.725 817.654 -199.692 -671.303 -432.553 990.744 -297.487 -56.206
++ 1 356.742 -594.237 831.364 754.211 -193.173 -998.171 333.944 -351.357 -744.725 817.654 -199.692 -671.303 -432.553 990.744 -297.487 -56.206
++ -679.981 200.398 -479.924 810.89 -784.052 -689.49 -869.548 -406.292 565.298 -839.914 216.972 794.149 -537.476 488.769 446.731 926.202 704.244 257.083 -149.391
+* 0.9736 0.9244 0.9106 1.0288 0.9567 0.9313 0.9956 0.929 1.0271 1.0903 0.9745 0.9066 0.9334 0.9625 1.0776 1.0891 1.0212 0.9794 0.9191
+max -4831 200.398 -479.924 810.89 -784.052 -689.49 -869.548 -406.292 565.298 -839.914 216.972 794.149 -537.476 488.769 446.731 926.202 704.244 257.083 -149.391
++ 1 -679.981 200.398 -479.924 810.89 -784.052 -689.49 -869.548 -406.292 565.298 -839.914 216.972 794.149 -537.476 488.769 446.731 926.202 704.244
++ 404.481 -847.873 -65.237 680.729 446.542 -606.261 794.428 -813.677 218.021 -725.582 -673.202 536.558 -104.167 -821.983 403.974 145.662 313.239 172.118 -619.374 -775.357 443.323 526.46 127.239 -955.094 -198.393 522.889 931.716 -777.877 -684.211 -165.608 -951.943 264.643 -154.394 -892.576 -336.962 542.017 703.662 -350.467 70.313 -817.367 -643.599 -619.422 700.187 -592.698 -438.997 555.468 -894.298 -226.167 -528.843 138.108 -292.406 203.912 939.397 523.482 843.744 -738.073 881.571 -67.176 914.359 159.409 -451.178 -686.315 302.895 -761.346
+* 1.0226 1.0242 1.0926 0.9656 1.0897 1.0529 0.9884 1.0289 1.0985 0.9913 1.046 1.0176 0.918 0.9646 1.0751 1.0588 1.0243 0.9877 0.9727 0.983 1.0097 1.0789 0.9747 0.9591 1.018 1.0579 1.0041 0.9078 1.068 0.9846 0.9079 0.9134 1.0871 0.9636 1.013 1.0469 0.9409 1.0784 1.0578 0.9208 1.0532 0.9632 0.9602 1.0742 1.0263 0.9076 1.0202 1.0636 1.0373 1.0016 1.0083 1.0902 1.0361 0.9945 0.9801 1.0861 1.0404 1.0724 0.9172 1.0706 1.072 0.9396 1.0908 0.9651
+max 404.481 -847.873 -65.237 680.729 446.542 -606.261 794.428 -813.677 218.021 -725.582 -673.202 536.558 -104.167 -821.983 403.974 145.662 313.239 172.118 -619.374 -775.357 443.323 526.46 127.239 -955.094 -198.393 522.889 931.716 -777.877 -684.211 -165.608 -951.943 264.643 3963 -892.576 -336.962 542.017 703.662 -350.467 70.313 -817.367 -643.599 -619.422 700.187 -592.698 -438.997 555.468 -894.298 -226.167 -528.843 138.108 -292.406 203.912 939.397 523.482 843.744 -738.073 881.571 -67.176 914.359 159.409 -451.178 -686.315 302.895 -761.346
++ 1 404.481 -847.873 -65.237 680.729 446.542 -606.261 794.428 -813.677 218.021 -725.582 -673.202 536.558 -104.167 -821.983 403.974 145.662 313.239
++ 112.877 -810.141 510.133 954.714 -279.409 658.651 -747.53 -779.974 183.481 868.624 130.797 -535.294 -701.566 831.118 408.666 981.083 -471.298 519.133 -660.695 -747.785 -203.582 -302.166 528.192 -146.478 -361.383 768.905 726.291 -103.418 550.902 -840.943 -377.903 754.296 -2.241 -775.29 -560.165 779.989 -227.09 987.323 954.571 167.264 713.991 -289.76 583.278 -885.362 -23.694 -965.343 -463.002 872.248 257.666 -906.216 675.787 749.296 908.77 -116.344 -712.989 541.796 176.852 -903.29 -12.635 231.178 546.426 245.566 -373.507 -825.434 -903.468 -766.394 -183.034 -222.255 832.994 4.416 652.68 357.41 405.443 685.954 717.816 387.279 -11.433 701.348 -498.227 -481.854 -750.209 -617.602 -771.386 -629.519 -366.299 407.094 972.507 281.77 418.699 73.322 -705.063 453.52 171.82 -83.952 685.994 898.132 -663.397 -963.777 -250.127 151.072 1.503 -410.124 -486.026 -112.483 -820.654 -18.37 790.675 759.171 554.659 -636.274 -213.954 -762.705 -603.882 -924.384 -871.18 446.165 -461.721 347.371 -17.992 -485.107 323.337 -19.222 -613.858 -456.587 1.915 -522.822 -33.959 -264.612 885.289
+* 0.9305 1.0577 0.9333 0.9086 1.0669 1.0524 0.9802 1.0795 0.9585 0.9754 1.0705 1.0608 1.0898 0.9675 1.0468 1.0837 1.0422 0.9686 1.086 1.0618 0.909 0.9969 1.0939 1.0602 1.0397 0.9149 1.0693 0.9528 0.9434 1.0475 0.9952 1.0994 1.0676 0.9167 0.9088 0.9358 0.9144 0.9552 0.9742 0.9037 1.0448 1.0619 0.9756 0.9991 1.0176 1.0975 1.0523 0.9389 1.0109 0.9607 1.0807 1.0742 0.9928 1.0899 1.057 1.0645 0.9714 1.0654 0.9325 1.0665 0.9761 1.0822 0.993 0.9551 0.9533 0.969 1.0754 0.9936 0.9662 1.0934 1.0574 0.9109 1.0009 1.0881 0.9794 0.9007 1.0137 1.0478 1.0512 1.0296 0.9827 0.9864 0.9228 1.0861 1.098 0.9237 0.9273 0.9056 0.9734 1.0507 0.9742 0.9515 0.9914 1.0247 1.0138 1.0007 0.9829 0.9894 1.0294 0.9616 1.0972 1.0316 1.0687 1.0299 1.0996 0.9024 0.9584 1.0103 1.0868 0.9883 0.9402 1.0208 1.0979 0.9023 0.9158 1.0244 0.9338 1.0854 0.9056 1.0428 0.9605 1.0193 1.0332 1.0 0.9699 1.0917 0.989 0.9418 0.9016
+max 112.877 -810.141 510.133 954.714 -279.409 658.651 -747.53 -779.974 183.481 868.624 130.797 -535.294 -701.566 831.118 408.666 981.083 -471.298 519.133 -660.695 -747.785 -203.582 -302.166 528.192 -146.478 -361.383 768.905 726.291 -103.418 550.902 -840.943 -377.903 754.296 -2.241 -775.29 -560.165 779.989 -227.09 987.323 954.571 167.264 713.991 -289.76 583.278 -885.362 -23.694 -965.343 -463.002 872.248 257.666 -906.216 675.787 749.296 908.77 -116.344 -712.989 4244 176.852 -903.29 -12.635 231.178 546.426 245.566 -373.507 -825.434 -903.468 -766.394 -183.034 -222.255 832.994 4.416 652.68 357.41 405.443 685.954 717.816 387.279 -11.433 701.348 -498.227 -481.854 -750.209 -617.602 -771.386 -629.519 -366.299 407.094 972.507 281.77 418.699 73.322 -705.063 453.52 171.82 -83.952 685.994 898.132 -663.397 -963.777 -250.127 151.072 1.503 -410.124 -486.026 -112.483 -820.654 -18.37 790.675 759.171 554.659 -636.274 -213.954 -762.705 -603.882 -924.384 -871.18 446.165 -461.721 347.371 -17.992 -485.107 323.337 -19.222 -613.858 -456.587 1.915 -522.822 -33.959 -264.612 885.289
++ 1 112.877 -810.141 510.133 954.714 -279.409 658.651 -747.53 -779.974 183.481 868.624 130.797 -535.294 -701.566 831.118 408.666 981.083 -471.298
+def {v} (vec {734104910643395106 6967989594430457734 -343231244499142076 5291370312391960608 3592472569388077186 7114037769657095759 8032716707038634984 5522490686462935390 1926021054771841705 2429786747588820809 -8218768327204716430 4778711898527840786 -1188446535500166333 6136695425992590655 -136133857546149257 -2192825382545872519 -9134815571641290036 6426976805579730572 4222704469286560547 -8212896843202332716 -502674153986449806 -8351177588132338269 4149053935599769752 -1151981193800655527 -3495614472478703275 4552003478998679243 -1255023840084182604 -6863643445627008315 3399337111696413918 -8212063014903063652 -2007960457542153923 -8748809830664042629 -6137581829387733047 -1149600747301947747 -2648943297748084630 -1258977181641450641 -4995639606931992540 4887570779767187884 8657805385908278034 -7580408071032461959 7060941967449379630 7162559741725461933 -8651100726704152610 -2246757956366769444 3794919779981294654 -1014416111571980226 7581166143075719597 -6536661873862868996 5916881437258221791 3540244098473582722 1628524614900082207 5564568808380377251 4539104101301265060 6773335606527210752 -6768535927096366536 5804509464453249857 1338692814989197476 7229138675998765955 4535373121658911869 -8473413720888690559 -4290361892463909278 -5698852019533958342 -6728090326277318948 6535200529232634429 -926580035958763528 -1689382616048282533 2817333624289455531 7350867058636099666 -2870781485313321350 -6429641359748538922 2431856849879189532 7844836704776749330 3175421059178906033 8392231783853978933 -8358818567547334932 -5734487444041704912 5078165930789958241 -4099417087997387315 -473013299051785845 4172814282985942911 3503621711958089705 -9012142363334216913 2848135605857021388 3536127634096045178 1591763303594166835 3024727403484418556 -8755337705918698106 3675757108855925043 -7647259346993914196 2847465409087731743})
+def {w} (vec {-590778369694623938 -4915313445332126541 -1617320314590673528 -4278221260332266587 -6714653736439764726 9217617383477484522 -8553314488744881751 5982984640841455638 3326652088551689513 -953633705881689371 -7111391658588964151 8631248355180790692 -6478250751618915366 1221539711308430378 4009706002315223368 -7934119399960782699 -2089664039943301627 -7958357031476609931 8643748087919872499 -413553858532779434 -2867197108752419103 -4416303086509711076 -1896455587539769028 -8773608585520702852 -8850761917539620928 6638735616114735834 -265400370226221010 1882946464243855010 -3071040172675455042 -8694803869332544770 3850272231032120667 -3318572072075984228 -1388365277915037129 -4685637506857135029 607096977780044790 8080488448531319316 -5619001416045955700 8941314425127145531 6261006052004815213 1796838168044817653 -6953767186778648354 1384242192694571294 6211872280998395607 -6386821096047073776 -3170901645349582547 -1311155133426527960 -4600507042023884333 6474029225499652465 -4941894063902559389 3871310700302812486 -115768553418774243 9169640555897016262 -8298052160808868268 -5407478112273382428 -5330141656088454538 -960421060091562319 8614446629826167532 3022705193078193871 8545329361256169342 -1858828137618447455 7810248766383280246 7609096934338705096 7556186338770820351 -5100496481814584626 4116153519570915343 -2141281654869714659 2503895042777728799 -3257302052635139018 -1950016384120684178 -3565757994624820882 -114464287061039587 6636889820521628894 5626377864635238081 8520876953629709545 1252277332876047950 -3988711913652567257 -8093146691041491084 514340907112242331 7873395855453484567 -1017256627525212127 1138497770911464347 7341868036210234778 -4502399466630233135 8825802533745672437 -1194579515051042265 -2373529059075085957 6198716666920667230 -637918866881425423 6544916007687169348 -128010678562402846})
+vec-sum v
+vec-min w
+vec-max (vec-slice v 1 89)
+vec-sum (vec-slice w 3 20)
@@ -0,0 +1,31 @@
+"hello"
+""
+"a \"quoted\" word\n"
+str-len "abcdefghijklmno"
+str-len "abcdefghijklmnop"
+str-cat "abcdefg" "hijklmno"
+str-cat "abcdefgh" "ijklmnop"
+str-len (str-cat "abcdefgh" "ijklmnop")
+str-sub "hello world, long string" 6 11
+str-sub "hello world, long string" 0 24
+str-sub "hello world, long string" 3 2
+str-sub "short" 0 9
+list "{ not a list (" "}}}" 1
+str-len 5
+str-cat "a" 1
+def {s} "0123456789abcdefXYZ"
+def {r} (str-cat s s s s)
+str-len r
+str-sub r 15 40
+str-sub (str-sub r 10 70) 5 30
+str-cat (str-sub r 0 3) (str-sub r 73 76)
+head (list "inline" "this one is not inline")
+eval {str-cat "tail " "position"}
+def {acc} "start:"
+def {grow} (\ {n & r} {grow (- n (/ n n)) (def {acc} (str-cat acc "xy"))})
+grow 100000
+str-len acc
+str-sub acc 0 10
+str-sub acc 199996 200006
+def {acc} "done"
+acc
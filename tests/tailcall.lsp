@@ -0,0 +1,11 @@
+def {down} (\ {n} {down (- n (/ n n))})
+down 1000000
+def {loop} (\ {n} {eval {loop (- n (/ n n))}})
+loop 1000000
+def {deep} (\ {n} {eval (list down n)})
+deep 1000000
+def {ping} (\ {n} {pong (- n (/ n n))})
+def {pong} (\ {n} {ping (- n (/ n n))})
+ping 1000000
+def {again} (\ {n} {eval (join (list again) (list (- n (/ n n))))})
+again 1000000
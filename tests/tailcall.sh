@@ -0,0 +1,29 @@
+#!/bin/sh
+# Recurse a million times in tail position, through the VM and through the
+# tree walker. Each loop counts down until the division by zero at n = 0,
+# so each must end in that error rather than a stack overflow. The run is
+# held to LIMIT_KB of virtual memory, far less than a million frames or
+# leaked values would need, so the loops must also run in constant space.
+# Sanitizer builds reserve too much address space to be run this way, and
+# the LISPC_ARENA build keeps an evaluation's garbage until it ends, so run
+# those with LIMIT_KB=unlimited.
+#
+# Usage: tests/tailcall.sh [path to lispc]
+
+LISPC=${1:-./lispc}
+DIR=$(dirname "$0")
+EXPECTED=5
+LIMIT_KB=${LIMIT_KB:-32768}
+
+status=0
+for mode in "" --no-vm; do
+    got=$( (ulimit -v "$LIMIT_KB"; "$LISPC" $mode < "$DIR/tailcall.lsp" 2>&1) \
+        | grep -c "Error: Division by zero!")
+    if [ "$got" -eq "$EXPECTED" ]; then
+        echo "ok   tailcall ${mode:-vm}"
+    else
+        echo "FAIL tailcall ${mode:-vm}: $got of $EXPECTED loops finished in $LIMIT_KB KB"
+        status=1
+    fi
+done
+exit $status
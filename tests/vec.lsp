@@ -0,0 +1,30 @@
+vec {1 2 3}
+vec-len (vec {1 2 3})
+vec-get (vec {5 6 7}) 1
+vec-get (vec {5 6 7}) 3
+vec-get (vec {5 6 7}) -1
+vec-slice (vec {1 2 3 4 5}) 1 3
+vec-slice (vec {1 2 3}) 2 1
+vec-list (vec {1 2 3})
+vec {1 2.5}
+vec {99999999999999999999}
+vec-sum (vec {1 2 3})
+vec-min (vec {4 -2 9})
+vec-max (vec {})
+vec-sum (vec {})
+vec-sum (vec {9223372036854775807 1})
+vec-slice (vec {1 2 3}) 0 3
+def {v} (vec {-1406612057389349638 -2617964757147985650 -5681649629593590626 -8963716282372353309 -7269866261640175410 3873967497689746629 4320394922427331813 4994904120472579950 5222316779801670737 2231898490752181523 4338869248983177878 1346346504888774549 -478390002440184639 -6205764617932445089 -7704704409753430000 -7211829655745093506 903770067171873218 -6464970203747338386 5235353205619132375 -4832560035266154933 1709934605245408858 -2157628786189134130 8762322830160704481 2413777053725803174 -8792404300741170008 8738880282603727250 -2838168939177790624 5316864552480125641 -5657360164616419767 -4347587173400400378 -5239777116787093564 -4555195463609390400 5787775738050116857 -1611835677211915582 844830225744879081 -1667282920679414365 921184253257697690})
+v
+vec-len v
+vec-get v 36
+vec-slice v 5 30
+vec-list (vec-slice v 30 37)
+vec-sum v
+vec-min v
+vec-max v
+vec-sum (vec-slice v 3 3)
+vec-len (vec-slice (vec-slice v 4 20) 2 9)
+vec-get (vec-slice (vec-slice v 4 20) 2 9) 0
+vec-get v 37
+vec-len {1 2}